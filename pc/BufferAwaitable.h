@@ -0,0 +1,83 @@
+#ifndef PC_BUFFER_AWAITABLE_H
+#define PC_BUFFER_AWAITABLE_H
+
+#include <chrono>
+#include <coroutine>
+#include <memory>
+#include "IPCOptions.h"
+
+class ISharedBuffer;
+class AwaitContext;
+
+/**
+ * An operation on the buffer that a coroutine can await with 'co_await', instead of blocking a thread while the buffer is full or empty.
+ * If the buffer is not ready, the coroutine is suspended and registers a waiter in the buffer, which makes a thread of the shared pool retry
+ * the operation once an item may be produced or consumed. The coroutine is resumed by that thread once the operation succeeds or the buffer
+ * is stopped.
+ */
+class BufferAwaitable
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] sharedBuffer The buffer to produce items into or to consume items from.
+     * @param[in] role Whether the operation produces or consumes items.
+     * @param[in] count The maximum number of items to produce or consume.
+     * @param[in] context Guards the accesses to 'sharedBuffer'. Once it is cancelled, the operation completes without any item.
+     */
+    BufferAwaitable(ISharedBuffer* sharedBuffer, ActorRole role, size_t count, const std::shared_ptr<AwaitContext>& context);
+
+    /**
+     * Tries the operation once, without suspending the coroutine.
+     *
+     * @return true if the operation is complete.
+     */
+    bool await_ready();
+
+    /**
+     * Suspends the coroutine until the buffer may be ready for the operation.
+     *
+     * @param[in] handle The suspended coroutine.
+     */
+    void await_suspend(std::coroutine_handle<> handle);
+
+    /**
+     * @return The number of produced or consumed items. It is 0 only if the buffer was stopped.
+     */
+    size_t await_resume() const;
+
+private:
+
+    /**
+     * Tries the operation once.
+     *
+     * @return true if the operation is complete, either because some items were moved or because the buffer was stopped.
+     */
+    bool tryOperation();
+
+    /**
+     * Registers a waiter in the buffer that schedules the next try of the operation on the shared pool. When the buffer is already ready
+     * or stopped, or the context is cancelled, the try is scheduled straight away.
+     *
+     * @param[in] handle The suspended coroutine.
+     */
+    void waitForBuffer(std::coroutine_handle<> handle);
+
+    /**
+     * Schedules the next try of the operation on the shared pool. The coroutine is resumed when the try completes the operation,
+     * and otherwise it waits for the buffer again.
+     *
+     * @param[in] handle The suspended coroutine.
+     */
+    void retry(std::coroutine_handle<> handle);
+
+    ISharedBuffer* sharedBuffer_;
+    ActorRole role_;
+    size_t count_;
+    std::shared_ptr<AwaitContext> context_;
+    size_t result_; //The number of items moved by the operation.
+};
+
+#endif
@@ -0,0 +1,38 @@
+#ifndef PC_BUFFER_STATISTICS_H
+#define PC_BUFFER_STATISTICS_H
+
+#include <cstddef>
+
+/**
+ * Statistics collected by the buffer shared among producers and consumers.
+ */
+struct BufferStatistics
+{
+    size_t spuriousWakeups; //The number of times that a waiting producer or consumer was woken up but could not reserve an item.
+    size_t recoveredSlots; //The number of slots of a shared memory buffer reclaimed from processes that died while filling or emptying them.
+    size_t droppedItems; //The number of items lost by the overflow policy: the new items rejected, or the old items dropped or overwritten.
+
+    BufferStatistics()
+    : spuriousWakeups(0)
+    , recoveredSlots(0)
+    , droppedItems(0)
+    {
+    }
+};
+
+/**
+ * Statistics collected by a producer or a consumer.
+ */
+struct ActorStatistics
+{
+    size_t items; //The number of items produced or consumed by the actor.
+    size_t operations; //The number of times that the actor tried to produce or consume items.
+
+    ActorStatistics()
+    : items(0)
+    , operations(0)
+    {
+    }
+};
+
+#endif
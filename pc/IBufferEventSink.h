@@ -0,0 +1,43 @@
+#ifndef PC_IBUFFER_EVENT_SINK_H
+#define PC_IBUFFER_EVENT_SINK_H
+
+#include <cstddef>
+
+/**
+ * Class that receives the events that happen in the shared buffer, like the production or consumption of items.
+ *
+ * The methods are called by producers and consumers while they interact with the buffer, so they should return quickly and
+ * they should not block. 'onBufferFull' and 'onBufferEmpty' may be called while the buffer holds its internal lock.
+ */
+class IBufferEventSink
+{
+public:
+
+    /**
+     * Called after a producer fills some items.
+     *
+     * @param[in] count The number of filled items.
+     */
+    virtual void onProduced(size_t count) = 0;
+
+    /**
+     * Called after a consumer empties some items.
+     *
+     * @param[in] count The number of emptied items.
+     */
+    virtual void onConsumed(size_t count) = 0;
+
+    /**
+     * Called when a producer finds the buffer full and it is about to wait.
+     */
+    virtual void onBufferFull() = 0;
+
+    /**
+     * Called when a consumer finds the buffer empty and it is about to wait.
+     */
+    virtual void onBufferEmpty() = 0;
+
+    virtual ~IBufferEventSink(){}
+};
+
+#endif
@@ -3,47 +3,134 @@
 
 #include <chrono>
 #include <vector>
+#include <string>
+#include <optional>
+#include <future>
 #include "IBufferItem.h"
+#include "IPCOptions.h"
+#include "BufferStatistics.h"
+#include "ProducerConsumer.h"
 
 /**
- * The interface class to manage producers and consumers
+ * The interface class to manage producers and consumers of a single buffer. To run several buffers in a process, use 'ProducerConsumer' objects instead.
  */
 class IPC
 {
 public:
-    using ItemsBuffer = std::vector<IBufferItem* >; //A type representing the buffer of items shared among producers and consumers.
+    using ItemsBuffer = ProducerConsumer::ItemsBuffer; //A type representing the buffer of items shared among producers and consumers.
+    using ActorHandle = ProducerConsumer::ActorHandle; //Identifies a producer or a consumer.
 
     /**
      * Sets the buffer that will be shared among producers and consumers. It also allow the internal buffer to start accepting consumers and producers.
      *
      * @param[in] buffer The shared buffer.
+     * @param[in] options The options to create the internal buffer, like the implementation to be used.
      * @note This method should be followed by a call to stop. Calling this method twice without calling stop will cause undefined behaviour.
      */
-    static void start(const ItemsBuffer& buffer);
+    static void start(const ItemsBuffer& buffer, const BufferOptions& options = BufferOptions());
+
+    /**
+     * Sets a buffer of items stored inline, in a vector of a concrete item type, to be shared among producers and consumers.
+     * The items are filled and emptied without virtual calls, so this is the faster choice when all the items have the same type.
+     *
+     * @param[in/out] items The shared items. The vector should outlive the call to stop and it should not be resized meanwhile.
+     * @param[in] options The options to create the internal buffer. Inline buffers always use the locked implementation, so 'options.backend' is ignored.
+     * @note This method should be followed by a call to stop. Calling this method twice without calling stop will cause undefined behaviour.
+     */
+    template <class Item>
+    static void startInline(std::vector<Item>& items, const BufferOptions& options = BufferOptions());
+
+    /**
+     * Creates a buffer of 'size' empty items in the shared memory segment 'name', so that producers and consumers of other processes can
+     * share it by calling 'attachShared'.
+     *
+     * @param[in] name The name of the segment, like "/myBuffer". It is removed by stop, but the processes already attached can keep using it.
+     * @param[in] size The number of items of the buffer.
+     * @param[in] options The options to create the internal buffer. Shared memory buffers always use the locked implementation, so 'options.backend' is ignored.
+     * @return false if the segment already exists or it could not be created.
+     * @note 'Item' should be trivially copyable, with non-virtual methods 'fill' and 'empty' and a conversion to bool. A default constructed 'Item' should be empty.
+     */
+    template <class Item>
+    static bool startShared(const std::string& name, size_t size, const BufferOptions& options = BufferOptions());
+
+    /**
+     * Attaches to the buffer of the shared memory segment 'name', created by 'startShared' in another process.
+     *
+     * @param[in] name The name of the segment.
+     * @param[in] options The options to create the internal buffer. The ordering of the items is the one of the process that created the segment.
+     * @return false if the segment does not exist, it was not created for items of type 'Item' or 64 buffers are already attached to it.
+     * @note Calling stop only stops the producers and consumers of this process.
+     * @note The library is not fork-safe. A process created by 'fork' after any actor was added should not add actors itself, but it can
+     * produce and consume items from its own thread with calls like 'tryProduce' or 'produceFor'.
+     */
+    template <class Item>
+    static bool attachShared(const std::string& name, const BufferOptions& options = BufferOptions());
 
     /**
      * Adds a producer to produce items into the buffer.
      *
      * @param[in] delay The delay the producer will take after producing an element.
+     * @return The handle of the producer, to remove it or change its delay later. It is 0 if the buffer is stopped.
+     */
+    static ActorHandle addProducer(const std::chrono::nanoseconds& delay);
+
+    /**
+     * Adds a producer to produce items into the buffer.
+     *
+     * @param[in] options The options of the producer, like the delay it will take after producing elements or the number of elements
+     * it will produce each time.
+     * @return The handle of the producer, to remove it or change its delay later. It is 0 if the buffer is stopped.
      */
-    static void addProducer(const std::chrono::milliseconds& delay);
+    static ActorHandle addProducer(const ActorOptions& options);
 
     /**
      * Adds a consumer to consume items from the buffer.
      *
      * @param[in] delay The delay the consumer will take after consuming an element.
+     * @return The handle of the consumer, to remove it or change its delay later. It is 0 if the buffer is stopped.
      */
-    static void addConsumer(const std::chrono::milliseconds& delay);
+    static ActorHandle addConsumer(const std::chrono::nanoseconds& delay);
 
     /**
-     * Removes a consumer.
+     * Adds a consumer to consume items from the buffer.
+     *
+     * @param[in] options The options of the consumer, like the delay it will take after consuming elements or the number of elements
+     * it will consume each time.
+     * @return The handle of the consumer, to remove it or change its delay later. It is 0 if the buffer is stopped.
      */
-    static void removeConsumer();
+    static ActorHandle addConsumer(const ActorOptions& options);
 
     /**
-     * Removes a producer.
+     * Removes a consumer. The call does not wait for the consumer to finish its current operation.
+     *
+     * @return A future that becomes ready once the consumer is stopped and destroyed.
      */
-    static void removeProducer();
+    static std::future<void> removeConsumer();
+
+    /**
+     * Removes a producer. The call does not wait for the producer to finish its current operation.
+     *
+     * @return A future that becomes ready once the producer is stopped and destroyed.
+     */
+    static std::future<void> removeProducer();
+
+    /**
+     * Removes the producer or the consumer 'handle'. The call does not wait for the actor to finish its current operation.
+     *
+     * @param[in] handle The handle returned when the actor was added.
+     * @return A future that becomes ready once the actor is stopped and destroyed. It is ready right away if there is no actor with the handle.
+     */
+    static std::future<void> remove(ActorHandle handle);
+
+    /**
+     * Changes the delay the producer or the consumer 'handle' takes after producing or consuming elements, or between two
+     * elements if it is 'FIXED_RATE'. It is applied from the next time the actor rests.
+     *
+     * @param[in] handle The handle returned when the actor was added.
+     * @param[in] delay The new delay.
+     * @return false if there is no actor with the handle.
+     */
+    static bool setDelay(ActorHandle handle, const std::chrono::nanoseconds& delay);
 
     /**
      * Removes all consumers.
@@ -60,10 +147,116 @@ public:
      */
     static void stop();
 
+    /**
+     * Returns an operation that a coroutine can await with 'co_await' to produce items into the buffer without blocking a thread.
+     *
+     * @param[in] count The maximum number of items to produce.
+     * @return The operation. Awaiting it gives the number of produced items, which is 0 only if the buffer is stopped.
+     */
+    static BufferAwaitable produce(size_t count = 1);
+
+    /**
+     * Returns an operation that a coroutine can await with 'co_await' to consume items from the buffer without blocking a thread.
+     *
+     * @param[in] count The maximum number of items to consume.
+     * @return The operation. Awaiting it gives the number of consumed items, which is 0 only if the buffer is stopped.
+     */
+    static BufferAwaitable consume(size_t count = 1);
+
+    /**
+     * Produces up to 'count' items into the buffer from the calling thread without waiting, so a thread that cannot block can shed or reroute
+     * its items when the buffer is full.
+     *
+     * @param[in] count The maximum number of items to produce.
+     * @return The number of produced items. It is 0 if the buffer is full or stopped.
+     */
+    static size_t tryProduce(size_t count = 1);
+
+    /**
+     * Consumes up to 'count' items from the buffer from the calling thread without waiting.
+     *
+     * @param[in] count The maximum number of items to consume.
+     * @return The number of consumed items. It is 0 if the buffer is empty or stopped.
+     */
+    static size_t tryConsume(size_t count = 1);
+
+    /**
+     * Produces up to 'count' items into the buffer from the calling thread, waiting until 'deadline' at most while the buffer is full.
+     *
+     * @param[in] deadline The point in time when the call gives up.
+     * @param[in] count The maximum number of items to produce.
+     * @return The number of produced items. It is 0 if the buffer is still full at 'deadline', or if it is stopped meanwhile.
+     */
+    static size_t produceUntil(const std::chrono::steady_clock::time_point& deadline, size_t count = 1);
+
+    /**
+     * Consumes up to 'count' items from the buffer from the calling thread, waiting until 'deadline' at most while the buffer is empty.
+     *
+     * @param[in] deadline The point in time when the call gives up.
+     * @param[in] count The maximum number of items to consume.
+     * @return The number of consumed items. It is 0 if the buffer is still empty at 'deadline', or if it is stopped meanwhile.
+     */
+    static size_t consumeUntil(const std::chrono::steady_clock::time_point& deadline, size_t count = 1);
+
+    /**
+     * Produces up to 'count' items as 'produceUntil' does, waiting 'timeout' at most.
+     *
+     * @param[in] timeout The longest time the call waits while the buffer is full.
+     * @param[in] count The maximum number of items to produce.
+     * @return The number of produced items.
+     */
+    static size_t produceFor(const std::chrono::nanoseconds& timeout, size_t count = 1);
+
+    /**
+     * Consumes up to 'count' items as 'consumeUntil' does, waiting 'timeout' at most.
+     *
+     * @param[in] timeout The longest time the call waits while the buffer is empty.
+     * @param[in] count The maximum number of items to consume.
+     * @return The number of consumed items.
+     */
+    static size_t consumeFor(const std::chrono::nanoseconds& timeout, size_t count = 1);
+
     /**
      * @return The index of the next item to be filled in the buffer.
      */
     static size_t getCurrentIndex();
+
+    /**
+     * @return The statistics collected by the buffer, like the number of spurious wakeups of producers and consumers.
+     */
+    static BufferStatistics getStatistics();
+
+    /**
+     * @param[in] handle The handle returned when the actor was added.
+     * @return The statistics collected by the producer or the consumer 'handle', like the number of items it produced or consumed,
+     * or nothing if there is no actor with the handle.
+     */
+    static std::optional<ActorStatistics> getStatistics(ActorHandle handle);
+
+private:
+
+    /**
+     * @return The object that manages the buffer, the producers and the consumers.
+     */
+    static ProducerConsumer& getInstance();
 };
 
-#endif
\ No newline at end of file
+template <class Item>
+void IPC::startInline(std::vector<Item>& items, const BufferOptions& options)
+{
+    getInstance().startInline(items, options);
+}
+
+template <class Item>
+bool IPC::startShared(const std::string& name, size_t size, const BufferOptions& options)
+{
+    return getInstance().startShared<Item>(name, size, options);
+}
+
+template <class Item>
+bool IPC::attachShared(const std::string& name, const BufferOptions& options)
+{
+    return getInstance().attachShared<Item>(name, options);
+}
+
+#endif
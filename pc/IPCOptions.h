@@ -0,0 +1,146 @@
+#ifndef PC_IPC_OPTIONS_H
+#define PC_IPC_OPTIONS_H
+
+#include <chrono>
+#include <cstddef>
+
+class IBufferEventSink;
+class RateLimiter;
+
+/**
+ * The implementation of the buffer shared among producers and consumers.
+ */
+enum class BufferBackend
+{
+    LOCKED,   //The items are reserved while holding a mutex, and producers and consumers wait on a condition variable. A single producer and a single consumer still take the mutex: there is no single producer/single consumer path.
+    LOCK_FREE //A bounded multi-producer/multi-consumer ring where the items are reserved with atomic operations. While there is only one producer, or only one consumer, that side reserves its items without any compare-and-exchange. A buffer of fewer than 2 items uses 'LOCKED' instead.
+};
+
+/**
+ * The order in which the items of the buffer are consumed.
+ */
+enum class BufferOrdering
+{
+    LIFO, //The last produced item is consumed first. Recently used items are reused while they are still in the cache, but old items can wait indefinitely.
+    FIFO  //The oldest produced item is consumed first, which bounds the time that an item waits in the buffer.
+};
+
+/**
+ * How producers and consumers wait while the buffer is full or empty, and while they rest between two interactions with the buffer.
+ */
+enum class WaitStrategy
+{
+    BLOCKING,       //Sleep on a condition variable. Idle actors do not use any CPU.
+    SPIN_THEN_PARK, //Spin for a short time executing a pause instruction, and then sleep on a condition variable.
+    YIELDING,       //Yield the processor in a loop.
+    BUSY_POLL       //Spin without sleeping. It gives the lowest latency, but each waiting actor keeps a core busy.
+};
+
+/**
+ * How the slots of a 'LOCK_FREE' buffer are laid out in memory.
+ */
+enum class SlotLayout
+{
+    COMPACT, //Several slots share a cache line. It uses less memory, but actors working on neighbouring slots invalidate each other's cache lines.
+    PADDED   //Each slot takes a whole cache line, so actors working on neighbouring slots do not falsely share it.
+};
+
+/**
+ * What a producer does when the buffer is full.
+ */
+enum class OverflowPolicy
+{
+    BLOCK,       //Wait until a consumer empties an item.
+    REJECT,      //Give up right away, dropping the new items.
+    DROP_OLDEST, //Empty the oldest items and produce the new ones in their slots.
+    OVERWRITE    //Fill the new items over the oldest ones without emptying them, so 'IBufferItem::fill' should accept a filled item.
+};
+
+/**
+ * The options to create the buffer shared among producers and consumers.
+ */
+struct BufferOptions
+{
+    BufferBackend backend; //The implementation of the shared buffer.
+    BufferOrdering ordering; //The order of the items in a 'LOCKED' buffer. A 'LOCK_FREE' buffer is always 'FIFO'.
+    IBufferEventSink* eventSink; //Receives the events of the buffer. It should outlive the buffer. If null, the events are ignored.
+    WaitStrategy waitStrategy; //How producers and consumers wait.
+    SlotLayout slotLayout; //The memory layout of the slots of a 'LOCK_FREE' buffer. The slots of a 'LOCKED' buffer are only accessed under its mutex.
+    OverflowPolicy overflowPolicy; //What producers do when the buffer is full. A buffer that drops or overwrites its oldest items is always 'FIFO'.
+
+    BufferOptions()
+    : backend(BufferBackend::LOCKED)
+    , ordering(BufferOrdering::LIFO)
+    , eventSink(nullptr)
+    , waitStrategy(WaitStrategy::BLOCKING)
+    , slotLayout(SlotLayout::COMPACT)
+    , overflowPolicy(OverflowPolicy::BLOCK)
+    {
+    }
+};
+
+/**
+ * How a producer or a consumer is executed.
+ */
+enum class ActorExecution
+{
+    DEDICATED_THREAD, //The actor runs on its own thread and blocks on the buffer with its wait strategy.
+    SHARED_POOL,      //The actor is a task of a pool with one thread per core. It never blocks: while the buffer is full or empty it waits to be rescheduled by the buffer.
+    COROUTINE         //The actor is a coroutine that awaits the buffer. It is resumed by the threads of the pool, and it only takes the memory of its frame.
+};
+
+/**
+ * Whether an actor or an awaited operation produces or consumes items.
+ */
+enum class ActorRole
+{
+    PRODUCER,
+    CONSUMER
+};
+
+/**
+ * When a producer or a consumer interacts with the buffer.
+ */
+enum class ActorPacing
+{
+    AFTER_OPERATION, //The actor rests 'delay' after each interaction, so its rate drifts with the time the interactions take.
+    FIXED_RATE       //The actor interacts at absolute deadlines, 'delay' apart for each item, so its rate does not drift with the load.
+};
+
+/**
+ * The options to create a producer or a consumer.
+ */
+struct ActorOptions
+{
+    std::chrono::nanoseconds delay; //The delay the actor will take after interacting with the buffer, or the interval between two items if it is 'FIXED_RATE'.
+    size_t batchSize; //The maximum number of items the actor will produce or consume each time it interacts with the buffer.
+    ActorExecution execution; //Whether the actor runs on its own thread or on the shared pool.
+    ActorPacing pacing; //Whether 'delay' is taken after each interaction or between the deadlines of consecutive items.
+    std::chrono::nanoseconds timeout; //How long a 'DEDICATED_THREAD' actor waits while the buffer is full or empty before it gives up and rests. 0 never waits, and the maximum waits until the buffer is ready. Pooled and coroutine actors never block.
+    RateLimiter* rateLimiter; //Caps the combined rate of the actors that share it, on top of 'delay'. It should outlive the actor. If null, the actor is not limited.
+
+    explicit ActorOptions(const std::chrono::nanoseconds& _delay, size_t _batchSize = 1, ActorExecution _execution = ActorExecution::DEDICATED_THREAD,
+                          ActorPacing _pacing = ActorPacing::AFTER_OPERATION)
+    : delay(_delay)
+    , batchSize(_batchSize)
+    , execution(_execution)
+    , pacing(_pacing)
+    , timeout(std::chrono::nanoseconds::max())
+    , rateLimiter(nullptr)
+    {
+    }
+
+    /**
+     * @param[in] itemsPerSecond The number of items the actor will produce or consume each second. It should be positive.
+     * @param[in] batchSize The maximum number of items the actor will produce or consume each time it interacts with the buffer.
+     * @param[in] execution Whether the actor runs on its own thread or on the shared pool.
+     * @return The options of a 'FIXED_RATE' actor that produces or consumes 'itemsPerSecond' items each second.
+     */
+    static ActorOptions atRate(double itemsPerSecond, size_t batchSize = 1, ActorExecution execution = ActorExecution::DEDICATED_THREAD)
+    {
+        return ActorOptions(std::chrono::nanoseconds(static_cast<std::chrono::nanoseconds::rep>(1e9 / itemsPerSecond)), batchSize, execution,
+                            ActorPacing::FIXED_RATE);
+    }
+};
+
+#endif
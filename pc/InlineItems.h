@@ -0,0 +1,121 @@
+#ifndef PC_INLINE_ITEMS_H
+#define PC_INLINE_ITEMS_H
+
+#include <cstddef>
+#include <new>
+#include <functional>
+#include <type_traits>
+#include "IBufferItem.h"
+
+/**
+ * The operations that a buffer of items stored inline needs on its items, whose type it does not know. The buffer only knows where the items
+ * are, and it calls these operations once for each contiguous range of items, so a batch costs a virtual call per range instead of one per item.
+ */
+class IInlineItems
+{
+public:
+
+    /**
+     * Fills 'count' contiguous items.
+     *
+     * @param[in/out] items The first item.
+     * @param[in] count The number of items.
+     */
+    virtual void fill(void* items, size_t count) const = 0;
+
+    /**
+     * Empties 'count' contiguous items.
+     *
+     * @param[in/out] items The first item.
+     * @param[in] count The number of items.
+     */
+    virtual void empty(void* items, size_t count) const = 0;
+
+    /**
+     * Calls 'visitor' for 'count' contiguous items. Only the items that are an 'IBufferItem' can be visited, and the other ones are skipped.
+     *
+     * @param[in/out] items The first item.
+     * @param[in] count The number of items.
+     * @param[in] visitor Called for each item.
+     */
+    virtual void visit(void* items, size_t count, const std::function<void(IBufferItem& item)>& visitor) const = 0;
+
+    /**
+     * Constructs 'count' contiguous default items over the memory at 'items', discarding what it held.
+     *
+     * @param[out] items The first item.
+     * @param[in] count The number of items.
+     */
+    virtual void reset(void* items, size_t count) const = 0;
+
+    /**
+     * @param[in] item The item.
+     * @return Whether 'item' is filled.
+     */
+    virtual bool isFilled(const void* item) const = 0;
+
+    /**
+     * @return The size of an item, in bytes.
+     */
+    virtual size_t getItemSize() const = 0;
+
+    virtual ~IInlineItems(){}
+};
+
+/**
+ * The operations of 'IInlineItems' on items of type 'Item'.
+ * 'Item' should have the methods 'fill' and 'empty' and a conversion to bool, as 'IBufferItem' has. They are called without virtual dispatch,
+ * so the compiler can inline them, and consecutive items share cache lines instead of being scattered across the heap.
+ */
+template <class Item>
+class InlineItems : public IInlineItems
+{
+public:
+
+    void fill(void* items, size_t count) const override
+    {
+        for(Item* item = static_cast<Item*>(items), *end = item + count; item != end; ++item)
+        {
+            item->Item::fill();
+        }
+    }
+
+    void empty(void* items, size_t count) const override
+    {
+        for(Item* item = static_cast<Item*>(items), *end = item + count; item != end; ++item)
+        {
+            item->Item::empty();
+        }
+    }
+
+    void visit(void* items, size_t count, const std::function<void(IBufferItem& item)>& visitor) const override
+    {
+        if constexpr (std::is_base_of<IBufferItem, Item>::value)
+        {
+            for(Item* item = static_cast<Item*>(items), *end = item + count; item != end; ++item)
+            {
+                visitor(*item);
+            }
+        }
+    }
+
+    void reset(void* items, size_t count) const override
+    {
+        for(size_t i = 0; i < count; ++i)
+        {
+            new (static_cast<Item*>(items) + i) Item();
+        }
+    }
+
+    bool isFilled(const void* item) const override
+    {
+        return static_cast<bool>(*static_cast<const Item*>(item));
+    }
+
+    size_t getItemSize() const override
+    {
+        return sizeof(Item);
+    }
+};
+
+#endif
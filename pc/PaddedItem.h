@@ -0,0 +1,16 @@
+#ifndef PC_PADDED_ITEM_H
+#define PC_PADDED_ITEM_H
+
+/**
+ * An item that takes a whole cache line.
+ * Items stored next to each other, like in the vector of 'IPC::startInline' or allocated one after the other, can share a cache line, and then
+ * actors filling and emptying neighbouring items at the same time invalidate each other's caches. Wrapping the item type in 'PaddedItem' avoids it.
+ * For example: std::vector<PaddedItem<MyItem>> items(size);
+ */
+template <class Item>
+struct alignas(64) PaddedItem: public Item
+{
+    using Item::Item;
+};
+
+#endif
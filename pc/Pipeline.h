@@ -0,0 +1,134 @@
+#ifndef PC_PIPELINE_H
+#define PC_PIPELINE_H
+
+#include <chrono>
+#include <vector>
+#include <list>
+#include <mutex>
+#include <memory>
+#include <functional>
+#include "IBufferItem.h"
+#include "IPCOptions.h"
+#include "ProducerConsumer.h"
+
+class IItemsBuffer;
+class IActor;
+struct PipelineStage;
+class ProducerConsumerManager;
+
+/**
+ * A chain of buffers where the items flow from each buffer to the next one, like parse -> enrich -> serialize.
+ * Producers fill the items of the first buffer and consumers empty the items of the last one. Between two consecutive buffers, the workers of
+ * a stage consume an item of the first buffer and hand it straight into the second one, in the same thread and without any glue thread in between.
+ */
+class Pipeline
+{
+public:
+    using ItemsBuffer = ProducerConsumer::ItemsBuffer; //A type representing the items of one buffer of the pipeline.
+    using Transform = std::function<void(IBufferItem& input, IBufferItem& output)>; //Moves the content of an item of a buffer to an item of the next one.
+
+    Pipeline();
+
+    /**
+     * Destructor. It stops the pipeline if stop has not been called.
+     */
+    ~Pipeline();
+
+    Pipeline(const Pipeline&) = delete;
+
+    Pipeline& operator=(const Pipeline&) = delete;
+
+    /**
+     * Creates a buffer for each element of 'buffers'. The stage 'i' moves the items of 'buffers[i]' to 'buffers[i + 1]'.
+     *
+     * @param[in] buffers The items of each buffer, from the first to the last one. There should be at least one.
+     * @param[in] transforms 'transforms[i]' moves the content of an item of 'buffers[i]' into an item of 'buffers[i + 1]', leaving the former
+     * empty and the latter filled. If a stage has no transform, or it is empty, the input item is emptied and the output item is filled.
+     * @param[in] options The options to create each buffer.
+     * @note This method should be followed by a call to stop. Calling this method twice without calling stop will cause undefined behaviour.
+     */
+    void start(const std::vector<ItemsBuffer>& buffers, const std::vector<Transform>& transforms = std::vector<Transform>(),
+               const BufferOptions& options = BufferOptions());
+
+    /**
+     * @return The number of stages, that is, the number of buffers minus one.
+     */
+    size_t getNumberOfStages() const;
+
+    /**
+     * Adds a producer to produce items into the first buffer.
+     *
+     * @param[in] options The options of the producer.
+     */
+    void addProducer(const ActorOptions& options);
+
+    /**
+     * Adds a consumer to consume items from the last buffer.
+     *
+     * @param[in] options The options of the consumer.
+     */
+    void addConsumer(const ActorOptions& options);
+
+    /**
+     * Adds a worker to move items from the buffer 'stage' to the buffer 'stage + 1'. A 'DEDICATED_THREAD' worker waits on its own thread while the
+     * buffer 'stage' is empty or the buffer 'stage + 1' is full. 'SHARED_POOL' and 'COROUTINE' workers both run as steps of the shared pool
+     * that never block: a step only consumes an item while the buffer 'stage + 1' has room for it.
+     *
+     * @param[in] stage The stage of the worker, lower than 'getNumberOfStages()'.
+     * @param[in] options The options of the worker. Each time, the worker moves up to 'options.batchSize' items and then waits 'options.delay'.
+     */
+    void addWorker(size_t stage, const ActorOptions& options);
+
+    /**
+     * Removes all producers.
+     */
+    void removeProducers();
+
+    /**
+     * Removes all consumers.
+     */
+    void removeConsumers();
+
+    /**
+     * Removes all the workers of a stage.
+     *
+     * @param[in] stage The stage of the workers.
+     */
+    void removeWorkers(size_t stage);
+
+    /**
+     * Stops the buffers and all the producers, workers and consumers. The items that are still in the buffers are not moved anymore.
+     */
+    void stop();
+
+    /**
+     * @param[in] buffer The position of the buffer in the pipeline.
+     * @return The number of items of the buffer 'buffer' that have been produced and not yet consumed.
+     */
+    size_t getCurrentIndex(size_t buffer) const;
+
+    /**
+     * @param[in] stage The stage of the workers.
+     * @return The number of items of the buffer 'stage' that the workers of the stage consumed but could not move to the buffer 'stage + 1',
+     * because it rejected them or because it or the workers were stopped meanwhile.
+     */
+    size_t getDroppedItems(size_t stage) const;
+
+private:
+
+    /**
+     * Stops and destroys all the workers of a stage. The quit signals of all of them are raised before waiting for any of them.
+     *
+     * @param[in] stage The stage of the workers.
+     * @note 'mutexWorkers_' should be held by the caller.
+     */
+    void destroyWorkers(size_t stage);
+
+    std::vector<std::unique_ptr<ProducerConsumerManager>> managers_; //Manage the buffers, the producers of the first one and the consumers of the last one.
+    std::vector<IItemsBuffer*> buffers_; //The buffers owned by 'managers_'.
+    std::vector<std::unique_ptr<PipelineStage>> stages_; //The buffers and the transform of each stage, shared by its workers.
+    std::vector<std::list<IActor*>> workers_; //The workers of each stage.
+    std::mutex mutexWorkers_; //Synchronizes accesses to 'workers_'.
+};
+
+#endif
@@ -0,0 +1,53 @@
+#ifndef PC_RATE_LIMITER_H
+#define PC_RATE_LIMITER_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <atomic>
+
+/**
+ * A token bucket that caps the combined rate of the producers or consumers that share it through 'ActorOptions::rateLimiter'. It lets
+ * 'burst' items through at once after being idle, and then 'itemsPerSecond' items each second.
+ *
+ * It is lock-free: the whole bucket is the time from which the next item conforms to the rate, which the actors move forward with a
+ * compare-and-swap, so it does not serialize them like the mutex of the buffer does.
+ */
+class RateLimiter
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] itemsPerSecond The maximum combined number of items moved each second by the actors that share the limiter. It should be positive.
+     * @param[in] burst The number of items that can be moved at once when the bucket is full. It should be at least the batch size of the actors,
+     * otherwise each batch waits for some of its own items.
+     */
+    RateLimiter(double itemsPerSecond, size_t burst);
+
+    RateLimiter(const RateLimiter&) = delete;
+
+    RateLimiter& operator=(const RateLimiter&) = delete;
+
+    /**
+     * Takes 'count' tokens from the bucket, even if it does not have them. The items are charged after they are moved, so an actor does
+     * not have to know in advance how many items it will be able to move.
+     *
+     * @param[in] count The number of items moved by the actor.
+     * @return The time from which the next items of the actor conform to the rate. It can be in the past, if the bucket has tokens left.
+     */
+    std::chrono::steady_clock::time_point acquire(size_t count);
+
+    /**
+     * @return The maximum number of items moved each second.
+     */
+    double getRate() const;
+
+private:
+    double interval_; //The time, in nanoseconds, a token takes to be added to the bucket.
+    int64_t tolerance_; //The time, in nanoseconds, 'burst' tokens take to be added to the bucket.
+    std::atomic<int64_t> nextTime_; //The time since the epoch of the steady clock, in nanoseconds, at which the bucket would be empty if no more tokens were taken.
+};
+
+#endif
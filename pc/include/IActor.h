@@ -1,19 +1,161 @@
 #ifndef PC_I_ACTOR_H
 #define PC_I_ACTOR_H
 
-#include <thread>
+#include <future>
 #include <mutex>
 #include <condition_variable>
+#include <atomic>
+#include "IPCOptions.h"
+#include "BufferStatistics.h"
 
-class SharedBuffer;
+class ISharedBuffer;
 
 /**
- * Class that represents an entity or actor that can interact with the shared buffer, like a producer or a consumer.
+ * The delay and the statistics of an actor. They are atomic, since they are updated by the thread that runs the actor while other threads
+ * change or read them.
+ */
+struct ActorCounters
+{
+    std::atomic<std::chrono::nanoseconds::rep> delay; //The delay, in nanoseconds, the actor takes after interacting with the buffer, or between two items.
+    std::atomic<size_t> items;
+    std::atomic<size_t> operations;
+
+    ActorCounters();
+
+    /**
+     * Records an interaction of the actor with the buffer.
+     *
+     * @param[in] count The number of items produced or consumed.
+     */
+    void record(size_t count);
+
+    /**
+     * @return The delay the actor takes after interacting with the buffer, or between two items.
+     */
+    std::chrono::nanoseconds getDelay() const;
+
+    /**
+     * @return The statistics of the actor.
+     */
+    ActorStatistics getStatistics() const;
+};
+
+/**
+ * Computes when an actor rests until, with the pacing of its options. An 'AFTER_OPERATION' actor rests the delay from the end of each
+ * interaction. A 'FIXED_RATE' actor rests until an absolute deadline, which moves the delay forward for each item of the last interaction,
+ * so the time the interactions take does not accumulate as drift.
+ */
+class ActorPacer
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] pacing The pacing of the actor.
+     */
+    explicit ActorPacer(ActorPacing pacing);
+
+    /**
+     * Starts a rest of the actor.
+     *
+     * @param[in] count The number of items of the last interaction with the buffer. It is 0 before the first one.
+     * @param[in] now The current time.
+     */
+    void beginRest(size_t count, const std::chrono::steady_clock::time_point& now);
+
+    /**
+     * @param[in] delay The delay of the actor. It can change during a rest, and then the deadline is computed again.
+     * @return The time the current rest ends.
+     */
+    std::chrono::steady_clock::time_point getDeadline(const std::chrono::nanoseconds& delay);
+
+private:
+    static constexpr std::chrono::milliseconds MAX_LAG{100}; //A 'FIXED_RATE' actor that falls further behind its deadlines starts them again from now instead of catching up.
+
+    ActorPacing pacing_;
+    std::chrono::steady_clock::time_point begin_; //The time the delay of the current rest is counted from.
+    size_t steps_; //The number of delays the current rest lasts.
+    std::chrono::steady_clock::time_point deadline_; //The end of the last rest. A 'FIXED_RATE' actor counts its next rest from it.
+    bool started_; //Whether there was a rest before.
+};
+
+/**
+ * Class that represents an actor that can be started and stopped, whatever the way it is executed.
+ */
+class IActor
+{
+public:
+
+    /**
+     * This actor starts to interact with the buffer.
+     *
+     * @param[in] options The options of this actor, like the delay it will take after interacting with the buffer.
+     */
+    virtual void start(const ActorOptions& options) = 0;
+
+    /**
+     * Stops this actor from interacting with the buffer. When the call returns, the actor is not interacting with the buffer anymore.
+     * By default, it calls 'requestStop' and then 'join'.
+     */
+    virtual void stop();
+
+    /**
+     * First phase of 'stop'. It raises the quit signal of this actor and returns without waiting for it, so the quit signals of many actors
+     * can be raised before waiting for any of them.
+     * @note An actor waiting on the buffer does not notice the signal until the buffer is notified.
+     */
+    virtual void requestStop() = 0;
+
+    /**
+     * Second phase of 'stop'. It waits until this actor, whose quit signal is raised by 'requestStop', does not interact with the buffer anymore.
+     */
+    virtual void join() = 0;
+
+    /**
+     * @return Whether this actor is running.
+     */
+    virtual bool isRunning() const = 0;
+
+    /**
+     * Changes the delay this actor takes after interacting with the buffer, or between two items if it is 'FIXED_RATE'. It is applied from
+     * the next time the actor rests.
+     *
+     * @param[in] delay The new delay.
+     */
+    virtual void setDelay(const std::chrono::nanoseconds& delay) = 0;
+
+    /**
+     * @return The statistics collected by this actor.
+     */
+    virtual ActorStatistics getStatistics() const = 0;
+
+    /**
+     * Allocates the memory of an actor with the default 'ActorAllocator', so the actors added after others are removed reuse their memory.
+     *
+     * @param[in] size The size of the actor.
+     * @return The memory of the actor.
+     */
+    static void* operator new(size_t size);
+
+    /**
+     * Returns the memory of a destroyed actor to the default 'ActorAllocator'.
+     *
+     * @param[in] pointer The memory of the actor.
+     * @param[in] size The size of the actor.
+     */
+    static void operator delete(void* pointer, size_t size);
+
+    virtual ~IActor(){}
+};
+
+/**
+ * Class that represents an entity or actor that can interact with the shared buffer, like a producer or a consumer, on its own thread.
  *
  * A producer interacts with the buffer by producing items in it.
  * A consumer interacts with the buffer by consuming items from it.
  */
-class IBufferActor
+class IBufferActor : public IActor
 {
 public:
 
@@ -22,39 +164,82 @@ public:
      * 
      * @param[in/out] sharedBuffer The buffer with which this actor will interact.
      */
-    IBufferActor(SharedBuffer* sharedBuffer);
+    IBufferActor(ISharedBuffer* sharedBuffer);
 
     /**
-     * This actor starts to interact with the buffer 'buffer_' by starting the thread 'thread_' and calling 'run'.
+     * This actor starts to interact with the buffer 'buffer_' by calling 'run' on a thread of the default 'ThreadCache'.
      *
-     * @param[in] delay The delay that this actor will take after interacting with the buffer.
+     * @param[in] options The options of this actor, like the delay it will take after interacting with the buffer.
+     */
+    void start(const ActorOptions& options) override;
+
+    /**
+     * Stops this actor from interacting with the shared buffer 'buffer_'. It raises 'quitSignal_', wakes up the buffers and waits until 'run' returns.
+     */
+    void stop() override;
+
+    /**
+     * Raises 'quitSignal_' and wakes up this actor if it is resting. It does not notify the buffers.
      */
-    void start(const std::chrono::milliseconds& delay);
+    void requestStop() override;
 
     /**
-     * Stops this actor from interacting with the shared buffer 'buffer_'.
+     * Waits until 'run' returns. The thread that ran it goes back to the cache.
      */
-    void stop();
+    void join() override;
 
     /**
      * @return Whether this actor is running.
      */
-    bool isRunning() const;
+    bool isRunning() const override;
+
+    /**
+     * Changes the delay this actor takes after interacting with the buffer. If the actor is resting, it is woken up to apply the new delay.
+     *
+     * @param[in] delay The new delay.
+     */
+    void setDelay(const std::chrono::nanoseconds& delay) override;
+
+    /**
+     * @return The statistics collected by this actor.
+     */
+    ActorStatistics getStatistics() const override;
 
-    virtual ~IBufferActor(){}
+    /**
+     * @param[in] actor The actor that waits on a buffer, or null if the caller is not an actor.
+     * @return Whether 'actor' is stopped. A caller that is not an actor is never stopped, so only its deadline or the buffer stopping end its wait.
+     */
+    static bool isStopped(const IBufferActor* actor);
 
 protected:
 
     /**
-     * Place this actor to rest by sleeping 'delay' milliseconds, unless 'quitSignal_' is raised, in which case
-     * the call returns immediately.
+     * @param[in] timeout How long an interaction with the buffer can wait while it is full or empty.
+     * @return The deadline of an interaction that starts now, or 'std::chrono::steady_clock::time_point::max()' if 'timeout' is the maximum duration.
+     */
+    static std::chrono::steady_clock::time_point getDeadline(const std::chrono::nanoseconds& timeout);
+
+    /**
+     * Place this actor to rest until the deadline computed by 'pacer_' with the delay of 'counters_', waiting with the wait strategy of
+     * 'sharedBuffer_', unless 'quitSignal_' is raised, in which case the call returns immediately. If the delay is changed by 'setDelay'
+     * meanwhile, the deadline is computed again with the new delay. The items of the last interaction are charged to 'rateLimiter_', and the
+     * rest lasts at least until it lets the next items through. Without delay nor rate limiter, the actor runs at full speed: the call only
+     * checks 'quitSignal_', without locking 'mutex_'.
      *
-     * @param[in] delay The amount of milliseconds that this actor will sleep.
-     * @return true if this actor was capable of sleeping 'delay' milliseconds, false if 'quitSignal_' was raised while the sleeping time.
+     * @param[in] count The number of items of the last interaction with the buffer. It is 0 before the first one.
+     * @return true if this actor was capable of sleeping the delay, false if 'quitSignal_' was raised while the sleeping time.
+     */
+    bool rest(size_t count);
+
+    /**
+     * Wakes up this actor if it is waiting on the buffers it interacts with. It is called by 'stop', but not by 'requestStop'.
      */
-    bool rest(const std::chrono::milliseconds& delay);
-    
-    SharedBuffer* sharedBuffer_; //The buffer that this actor will interact with.
+    virtual void notifyBuffers();
+
+    ISharedBuffer* sharedBuffer_; //The buffer that this actor will interact with.
+    ActorCounters counters_; //The delay of this actor, set by 'start' and 'setDelay', and its statistics. 'run' should record each interaction with the buffer.
+    ActorPacer pacer_; //Computes the deadlines of 'rest' with the pacing set by 'start'.
+    RateLimiter* rateLimiter_; //The rate limiter set by 'start', or null.
 
 private:
 
@@ -62,12 +247,14 @@ private:
      * This is the asynchronous method that this actor will execute to interact with the shared buffer 'sharedBuffer_'.
      * This method will be executed until 'quitSignal_' is raised or until 'sharedBuffer_' is stopped.
      *
-     * @param[in] delay The delay that this actor will take after interacting with the buffer.
+     * @param[in] options The options of this actor.
      */
-    virtual void run(const std::chrono::milliseconds& delay) = 0;
+    virtual void run(const ActorOptions& options) = 0;
+
+    static constexpr int FIXED_RATE_TIMER_SLACK = 1; //The timer slack, in nanoseconds, of the thread of a 'FIXED_RATE' actor while it runs.
 
-    std::thread thread_;
-    bool quitSignal_;
+    std::future<void> finished_; //Ready once 'run' returns on the thread of 'ThreadCache' that runs it.
+    std::atomic<bool> quitSignal_; //Written under 'mutex_', and read without it by 'isRunning' and by 'rest' when there is no delay.
     std::mutex mutex_;
     std::condition_variable stopCV_;
 };
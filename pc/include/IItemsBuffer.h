@@ -0,0 +1,67 @@
+#ifndef PC_I_ITEMS_BUFFER_H
+#define PC_I_ITEMS_BUFFER_H
+
+#include <functional>
+#include "IBufferItem.h"
+#include "ISharedBuffer.h"
+
+/**
+ * A shared buffer of 'IBufferItem' objects that lets the actors work on the reserved items themselves, instead of just filling and emptying them.
+ * For example, a pipeline stage empties an item of a buffer by moving its content into an item of the next buffer.
+ */
+class IItemsBuffer: public ISharedBuffer
+{
+public:
+    using ItemVisitor = std::function<void(IBufferItem& item)>; //Called for each reserved item, without holding any lock of the buffer.
+
+    using ISharedBuffer::produceBatch;
+    using ISharedBuffer::consumeBatch;
+    using ISharedBuffer::tryProduceBatch;
+    using ISharedBuffer::tryConsumeBatch;
+
+    /**
+     * Reserves up to 'count' items as 'produceBatch' does, but calls 'fill' for each of them instead of 'IBufferItem::fill'.
+     *
+     * @param[in] producer The producer.
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] fill Fills the reserved items. When it is empty, 'IBufferItem::fill' is called.
+     * @return The number of filled items.
+     */
+    virtual size_t produceBatch(const IBufferActor* producer, size_t count, const ItemVisitor& fill) = 0;
+
+    /**
+     * Reserves up to 'count' items as 'consumeBatch' does, but calls 'empty' for each of them instead of 'IBufferItem::empty'.
+     *
+     * @param[in] consumer The consumer.
+     * @param[in] count The maximum number of items to empty.
+     * @param[in] empty Empties the reserved items. When it is empty, 'IBufferItem::empty' is called.
+     * @return The number of emptied items.
+     */
+    virtual size_t consumeBatch(const IBufferActor* consumer, size_t count, const ItemVisitor& empty) = 0;
+
+    /**
+     * Reserves up to 'count' items as 'tryProduceBatch' does, without waiting, but calls 'fill' for each of them instead of 'IBufferItem::fill'.
+     *
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] fill Fills the reserved items. When it is empty, 'IBufferItem::fill' is called.
+     * @return The number of filled items, 0 if the buffer is full or stopped.
+     */
+    virtual size_t tryProduceBatch(size_t count, const ItemVisitor& fill) = 0;
+
+    /**
+     * Reserves up to 'count' items as 'tryConsumeBatch' does, without waiting, but calls 'empty' for each of them instead of 'IBufferItem::empty'.
+     *
+     * @param[in] count The maximum number of items to empty.
+     * @param[in] empty Empties the reserved items. When it is empty, 'IBufferItem::empty' is called.
+     * @return The number of emptied items, 0 if the buffer is empty or stopped.
+     */
+    virtual size_t tryConsumeBatch(size_t count, const ItemVisitor& empty) = 0;
+
+    /**
+     * @param[in] role Whether the caller produces or consumes items.
+     * @return Whether an item can be reserved for 'role' right now, which is what 'addWaiter' checks before registering a waiter. It is false if the buffer is stopped.
+     */
+    virtual bool isReady(ActorRole role) const = 0;
+};
+
+#endif
@@ -0,0 +1,177 @@
+#ifndef PC_I_SHARED_BUFFER_H
+#define PC_I_SHARED_BUFFER_H
+
+#include <cstddef>
+#include <chrono>
+#include <functional>
+#include "BufferStatistics.h"
+#include "IPCOptions.h"
+
+class IBufferActor;
+class IWaitStrategy;
+
+/**
+ * Class that represents the buffer shared between producers and consumers.
+ * Producers insert items in the buffer by calling 'produce' and consumers extract items from it by calling 'consume'.
+ */
+class ISharedBuffer
+{
+public:
+
+    /**
+     * Fills the next empty item of the buffer. This is the producer role.
+     *
+     * @param[in] producer The producer.
+     * @note If the buffer is full, this call will block until a consumer consumes an item, the buffer is stopped or 'producer' is stopped.
+     */
+    virtual void produce(const IBufferActor* producer) = 0;
+
+    /**
+     * Empties the next filled item of the buffer. This is the consumer role.
+     *
+     * @param[in] consumer The consumer.
+     * @note If the buffer is empty, this call will block until a producer produces an item, the buffer is stopped or 'consumer' is stopped.
+     */
+    virtual void consume(const IBufferActor* consumer) = 0;
+
+    /**
+     * Fills up to 'count' consecutive empty items of the buffer, reserving all of them at once and waking up the waiting actors once.
+     *
+     * @param[in] producer The producer.
+     * @param[in] count The maximum number of items to fill.
+     * @return The number of filled items.
+     * @note If the buffer is full, this call will block as 'produce' does and return 0.
+     */
+    virtual size_t produceBatch(const IBufferActor* producer, size_t count) = 0;
+
+    /**
+     * Empties up to 'count' consecutive filled items of the buffer, reserving all of them at once and waking up the waiting actors once.
+     *
+     * @param[in] consumer The consumer.
+     * @param[in] count The maximum number of items to empty.
+     * @return The number of emptied items.
+     * @note If the buffer is empty, this call will block as 'consume' does and return 0.
+     */
+    virtual size_t consumeBatch(const IBufferActor* consumer, size_t count) = 0;
+
+    /**
+     * Fills up to 'count' consecutive empty items of the buffer as 'produceBatch' does, but it returns 0 instead of waiting when the buffer is full.
+     *
+     * @param[in] count The maximum number of items to fill.
+     * @return The number of filled items.
+     */
+    virtual size_t tryProduceBatch(size_t count) = 0;
+
+    /**
+     * Fills up to 'count' items as 'tryProduceBatch' does, for a caller that keeps the items that do not fit and tries again once the buffer
+     * has room, like a pooled actor or an awaiting coroutine. Since those items are not given up, 'OverflowPolicy::REJECT' does not count them as dropped.
+     *
+     * @param[in] count The maximum number of items to fill.
+     * @return The number of filled items.
+     */
+    virtual size_t retryProduceBatch(size_t count) = 0;
+
+    /**
+     * Empties up to 'count' consecutive filled items of the buffer as 'consumeBatch' does, but it returns 0 instead of waiting when the buffer is empty.
+     *
+     * @param[in] count The maximum number of items to empty.
+     * @return The number of emptied items.
+     */
+    virtual size_t tryConsumeBatch(size_t count) = 0;
+
+    /**
+     * Fills up to 'count' consecutive empty items of the buffer as 'produceBatch' does, but while the buffer is full it only waits until 'deadline'.
+     *
+     * @param[in] producer The producer, or null if the caller is not an actor.
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] deadline The point in time when the call gives up. 'std::chrono::steady_clock::time_point::max()' waits as 'produceBatch' does.
+     * @return The number of filled items. It is 0 if the buffer is still full at 'deadline', or if the buffer or 'producer' is stopped.
+     */
+    virtual size_t produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline) = 0;
+
+    /**
+     * Empties up to 'count' consecutive filled items of the buffer as 'consumeBatch' does, but while the buffer is empty it only waits until 'deadline'.
+     *
+     * @param[in] consumer The consumer, or null if the caller is not an actor.
+     * @param[in] count The maximum number of items to empty.
+     * @param[in] deadline The point in time when the call gives up. 'std::chrono::steady_clock::time_point::max()' waits as 'consumeBatch' does.
+     * @return The number of emptied items. It is 0 if the buffer is still empty at 'deadline', or if the buffer or 'consumer' is stopped.
+     */
+    virtual size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline) = 0;
+
+    /**
+     * Registers 'waiter' to be called once, when an item may be produced (for a producer) or consumed (for a consumer), so that the callers that
+     * do not block a thread, like the pooled actors and the coroutines, do not have to poll the buffer. Each published item calls at most one
+     * waiter of the opposite role, as it wakes up at most one blocked actor, and stopping or notifying the buffer calls all of them.
+     *
+     * @param[in] role The role of the caller that waits.
+     * @param[in] waiter The function to call. It may be called while the buffer is locked, so it should only schedule work and not call the buffer.
+     * @return false if the buffer is stopped or an item can already be produced or consumed, in which case 'waiter' is not registered.
+     * @note The caller should try its operation again when 'waiter' is called, since another caller may have taken the item first.
+     */
+    virtual bool addWaiter(ActorRole role, const std::function<void()>& waiter) = 0;
+
+    /**
+     * Stops the buffer from accepting and/or returning elements.
+     */
+    virtual void stop() = 0;
+
+    /**
+     * Notifies that an external event happened. An example of an external event is the removal of a producer or a consumer.
+     * All the waiting producers and consumers are woken up.
+     */
+    virtual void notify() = 0;
+
+    /**
+     * Whether producers and consumers can produce and consume elements respectively.
+     */
+    virtual bool isRunning() const = 0;
+
+    /**
+     * @return The index of the next item to be filled in the buffer, that is, the number of items reserved by producers and not yet
+     * reserved by consumers.
+     */
+    virtual size_t getCurrentIndex() const = 0;
+
+    /**
+     * @return The statistics collected by the buffer.
+     */
+    virtual BufferStatistics getStatistics() const = 0;
+
+    /**
+     * @return The strategy used to wait while the buffer is full or empty. The actors also use it to rest.
+     */
+    virtual IWaitStrategy& getWaitStrategy() = 0;
+
+    /**
+     * Sets the number of producers that are interacting with the buffer, so that the buffer can use a faster path when there is only one.
+     *
+     * @param[in] numberOfProducers The number of producers.
+     * @note When the number increases, this method should be called before the new producer starts to produce items.
+     * @note Only the lock-free ring has such a path. The buffers that reserve their items under a mutex ignore the number.
+     */
+    virtual void setNumberOfProducers(size_t /*numberOfProducers*/) {}
+
+    /**
+     * Sets the number of consumers that are interacting with the buffer, so that the buffer can use a faster path when there is only one.
+     *
+     * @param[in] numberOfConsumers The number of consumers.
+     * @note When the number increases, this method should be called before the new consumer starts to consume items.
+     * @note Only the lock-free ring has such a path. The buffers that reserve their items under a mutex ignore the number.
+     */
+    virtual void setNumberOfConsumers(size_t /*numberOfConsumers*/) {}
+
+    /**
+     * Tells the buffer that threads that are not actors, like the callers of 'tryProduceBatch' or 'consumeBatchUntil', also produce or consume
+     * items. From then on the buffer does not use its single producer or single consumer path for that role, whatever the number set by
+     * 'setNumberOfProducers' or 'setNumberOfConsumers'.
+     *
+     * @param[in] role The role of the callers.
+     * @note It should be called before the first of those calls. Calling it again has no effect.
+     */
+    virtual void addExternalCallers(ActorRole /*role*/) {}
+
+    virtual ~ISharedBuffer(){}
+};
+
+#endif
@@ -0,0 +1,65 @@
+#ifndef PC_ACTOR_ALLOCATOR_H
+#define PC_ACTOR_ALLOCATOR_H
+
+#include <cstddef>
+#include <unordered_map>
+#include <vector>
+#include <mutex>
+
+/**
+ * Allocates the memory of the actors. The memory of a destroyed actor is kept in a free list of blocks of its size, so the next actor of the same
+ * type reuses it without going to the heap.
+ */
+class ActorAllocator
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] maxFreeBlocks The maximum number of free blocks kept for each size. The blocks freed beyond it are returned to the heap.
+     */
+    explicit ActorAllocator(size_t maxFreeBlocks);
+
+    /**
+     * Destructor. It returns the free blocks to the heap.
+     */
+    ~ActorAllocator();
+
+    ActorAllocator(const ActorAllocator&) = delete;
+
+    ActorAllocator& operator=(const ActorAllocator&) = delete;
+
+    /**
+     * @param[in] size The size of the block.
+     * @return A block of 'size' bytes, taken from the free list of its size if it is not empty.
+     */
+    void* allocate(size_t size);
+
+    /**
+     * Puts a block back in the free list of its size.
+     *
+     * @param[in] pointer The block, returned by 'allocate'.
+     * @param[in] size The size of the block.
+     */
+    void deallocate(void* pointer, size_t size);
+
+    /**
+     * @return The number of free blocks of all sizes.
+     */
+    size_t getNumberOfFreeBlocks();
+
+    /**
+     * @return The allocator of the actors of the process.
+     */
+    static ActorAllocator& getDefault();
+
+private:
+    static constexpr size_t DEFAULT_MAX_FREE_BLOCKS = 1024;
+
+    size_t maxFreeBlocks_;
+    std::unordered_map<size_t, std::vector<void*>> freeBlocks_; //The free blocks of each size.
+    std::mutex mutex_; //Synchronizes accesses to 'freeBlocks_'.
+};
+
+#endif
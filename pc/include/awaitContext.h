@@ -0,0 +1,60 @@
+#ifndef PC_AWAIT_CONTEXT_H
+#define PC_AWAIT_CONTEXT_H
+
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Guards the accesses of suspended coroutines to a buffer. Once it is cancelled, the coroutines are resumed without accessing the buffer anymore,
+ * so the buffer can be destroyed while their frames are still waiting to be resumed.
+ * Entering and leaving only use atomic operations. The mutex is only taken by the last access to leave a cancelled context, to wake up
+ * 'waitForAccesses'.
+ */
+class AwaitContext
+{
+public:
+    AwaitContext();
+
+    /**
+     * Starts an access to the buffer. Each successful call should be followed by a call to 'leave'.
+     *
+     * @return false if the context is cancelled, in which case the buffer should not be accessed.
+     */
+    bool enter();
+
+    /**
+     * Ends an access to the buffer started by 'enter'.
+     */
+    void leave();
+
+    /**
+     * Cancels the context. When the call returns, no coroutine is accessing the buffer and no coroutine will access it anymore.
+     */
+    void cancel();
+
+    /**
+     * Cancels the context without waiting for the accesses in progress. No coroutine will start a new access to the buffer.
+     */
+    void requestCancel();
+
+    /**
+     * Waits until the accesses in progress end.
+     *
+     * @note The context should be cancelled first. Otherwise, the last access to leave does not wake up the caller.
+     */
+    void waitForAccesses();
+
+    /**
+     * @return Whether the context is cancelled.
+     */
+    bool isCancelled();
+
+private:
+    std::atomic<size_t> accesses_; //The number of accesses in progress, including the attempts of 'enter' that find the context cancelled.
+    std::atomic<bool> cancelled_;
+    std::mutex mutex_; //To put 'waitForAccesses' to sleep until the accesses in progress end.
+    std::condition_variable accessesCV_;
+};
+
+#endif
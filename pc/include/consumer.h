@@ -14,16 +14,16 @@ public:
     /**
      * @param[in/out] buffer The buffer where the consumer will extract values from.
      */
-    explicit Consumer(SharedBuffer* buffer);
+    explicit Consumer(ISharedBuffer* buffer);
 
 private:
 
     /**
      * Starts extracting elements from the buffer.
      *
-     * @param[in] delay The delay that the consumer will take after consuming one item.
+     * @param[in] options The options of the consumer. Each time, the consumer will consume up to 'options.batchSize' items and then wait 'options.delay', or the delay set later by 'setDelay'.
      */
-    void run(const std::chrono::milliseconds& delay) override;
+    void run(const ActorOptions& options) override;
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,118 @@
+#ifndef PC_COROUTINE_ACTOR_H
+#define PC_COROUTINE_ACTOR_H
+
+#include <chrono>
+#include <coroutine>
+#include <memory>
+#include "IActor.h"
+#include "executor.h"
+#include "awaitContext.h"
+
+/**
+ * A producer or a consumer that runs as a coroutine. It awaits the buffer with 'BufferAwaitable' and rests by awaiting a timer of an 'Executor',
+ * so it does not need a thread or a stack of its own.
+ */
+class CoroutineActor : public IActor
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] sharedBuffer The buffer with which this actor will interact.
+     * @param[in] role Whether this actor produces or consumes items.
+     * @param[in/out] executor The executor that will resume the coroutine of this actor after it rests. It should outlive this actor.
+     */
+    CoroutineActor(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor);
+
+    /**
+     * Starts the coroutine of this actor.
+     *
+     * @param[in] options The options of this actor.
+     */
+    void start(const ActorOptions& options) override;
+
+    /**
+     * Cancels the context of the coroutine, so it will not access the buffer anymore. Its frame is destroyed the next time it is resumed.
+     */
+    void requestStop() override;
+
+    /**
+     * Waits until the coroutine is not accessing the buffer.
+     */
+    void join() override;
+
+    /**
+     * @return Whether this actor is running.
+     */
+    bool isRunning() const override;
+
+    /**
+     * Changes the delay this actor takes after producing or consuming items. It is applied from the next time the coroutine rests.
+     *
+     * @param[in] delay The new delay.
+     */
+    void setDelay(const std::chrono::nanoseconds& delay) override;
+
+    /**
+     * @return The statistics collected by this actor.
+     */
+    ActorStatistics getStatistics() const override;
+
+private:
+
+    /**
+     * The return type of the coroutine of the actor. The coroutine starts right away and its frame is destroyed when it finishes.
+     */
+    struct Task
+    {
+        struct promise_type
+        {
+            Task get_return_object() { return {}; }
+            std::suspend_never initial_suspend() { return {}; }
+            std::suspend_never final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception();
+        };
+    };
+
+    /**
+     * Suspends the coroutine until 'time'. It is not suspended if 'context' is cancelled.
+     */
+    struct RestAwaitable
+    {
+        Executor& executor;
+        std::chrono::steady_clock::time_point time;
+        std::shared_ptr<AwaitContext> context;
+
+        bool await_ready() const;
+        void await_suspend(std::coroutine_handle<> handle) const;
+
+        /**
+         * @return false if 'context' is cancelled.
+         */
+        bool await_resume() const;
+    };
+
+    /**
+     * The coroutine of the actor. It rests the delay of 'counters', paced as 'options.pacing' says, and then produces or consumes up to
+     * 'options.batchSize' items, until 'context' is cancelled or the buffer is stopped. The parameters are copied into the frame, so the coroutine does not depend on the lifetime of the actor.
+     *
+     * @param[in/out] sharedBuffer The buffer with which the actor interacts.
+     * @param[in] role Whether the actor produces or consumes items.
+     * @param[in/out] executor The executor that resumes the coroutine after it rests.
+     * @param[in] options The options of the actor.
+     * @param[in] context Cancelled by 'stop'.
+     * @param[in/out] counters The delay of the actor and its statistics.
+     */
+    static Task run(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor, ActorOptions options, std::shared_ptr<AwaitContext> context,
+                    std::shared_ptr<ActorCounters> counters);
+
+    ISharedBuffer* sharedBuffer_;
+    ActorRole role_;
+    Executor& executor_;
+    std::shared_ptr<AwaitContext> context_;
+    std::shared_ptr<ActorCounters> counters_; //Shared with the coroutine, which can outlive this actor.
+};
+
+#endif
@@ -0,0 +1,165 @@
+#ifndef PC_EVENT_SINK_H
+#define PC_EVENT_SINK_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <iostream>
+#include "IBufferEventSink.h"
+
+/**
+ * An event sink that ignores all the events.
+ */
+class NullEventSink : public IBufferEventSink
+{
+public:
+    void onProduced(size_t count) override;
+
+    void onConsumed(size_t count) override;
+
+    void onBufferFull() override;
+
+    void onBufferEmpty() override;
+};
+
+/**
+ * An event sink that counts the events. Each counter lives in its own cache line, so producers and consumers do not invalidate each other's counters.
+ */
+class CountingEventSink : public IBufferEventSink
+{
+public:
+    CountingEventSink();
+
+    void onProduced(size_t count) override;
+
+    void onConsumed(size_t count) override;
+
+    void onBufferFull() override;
+
+    void onBufferEmpty() override;
+
+    /**
+     * @return The number of produced items.
+     */
+    size_t getProduced() const;
+
+    /**
+     * @return The number of consumed items.
+     */
+    size_t getConsumed() const;
+
+    /**
+     * @return The number of times that a producer found the buffer full.
+     */
+    size_t getBufferFull() const;
+
+    /**
+     * @return The number of times that a consumer found the buffer empty.
+     */
+    size_t getBufferEmpty() const;
+
+private:
+    alignas(64) std::atomic<size_t> produced_;
+    alignas(64) std::atomic<size_t> consumed_;
+    alignas(64) std::atomic<size_t> bufferFull_;
+    alignas(64) std::atomic<size_t> bufferEmpty_;
+};
+
+/**
+ * An event sink that writes the events to a stream from a background thread.
+ *
+ * Producers and consumers only push the events into a lock-free ring, which is drained by the thread 'thread_'. If the ring is full,
+ * the event is dropped instead of blocking the caller.
+ */
+class AsyncLogEventSink : public IBufferEventSink
+{
+public:
+
+    /**
+     * Constructor. It starts the thread that writes the events.
+     *
+     * @param[in/out] stream The stream where the events will be written.
+     * @param[in] capacity The maximum number of events that can wait to be written. A capacity of 0 is taken as 1.
+     */
+    explicit AsyncLogEventSink(std::ostream& stream = std::cout, size_t capacity = 4096);
+
+    /**
+     * Destructor. It writes the pending events and stops the thread 'thread_'.
+     */
+    ~AsyncLogEventSink() override;
+
+    void onProduced(size_t count) override;
+
+    void onConsumed(size_t count) override;
+
+    void onBufferFull() override;
+
+    void onBufferEmpty() override;
+
+    /**
+     * @return The number of events that could not be written because the ring was full.
+     */
+    size_t getDroppedEvents() const;
+
+private:
+
+    enum class EventType
+    {
+        PRODUCED,
+        CONSUMED,
+        BUFFER_FULL,
+        BUFFER_EMPTY
+    };
+
+    /**
+     * A position of the ring. The event can be written when 'sequence' is equal to the position, and it can be read when 'sequence'
+     * is equal to the position plus one.
+     */
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        EventType type;
+        size_t count;
+    };
+
+    /**
+     * Pushes an event into the ring, or drops it if the ring is full.
+     *
+     * @param[in] type The type of the event.
+     * @param[in] count The number of items of the event.
+     */
+    void push(EventType type, size_t count);
+
+    /**
+     * Writes all the events of the ring into 'stream_'.
+     */
+    void drain();
+
+    /**
+     * Writes the event of producing or consuming items into 'stream_', like "Pushing value" or "Pushing 3 values".
+     *
+     * @param[in] action The verb of the event.
+     * @param[in] count The number of items of the event.
+     */
+    void write(const char* action, size_t count);
+
+    /**
+     * The method executed by 'thread_'. It drains the ring periodically until 'quitSignal_' is raised.
+     */
+    void run();
+
+    std::ostream& stream_;
+    size_t capacity_;
+    std::unique_ptr<Slot[]> slots_;
+    alignas(64) std::atomic<size_t> tail_; //The position of the next event to be pushed.
+    alignas(64) size_t head_; //The position of the next event to be written. Only accessed by 'thread_'.
+    alignas(64) std::atomic<size_t> droppedEvents_;
+    bool quitSignal_;
+    std::mutex mutex_; //To synchronize accesses to 'quitSignal_'.
+    std::condition_variable quitCV_;
+    std::thread thread_;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#ifndef PC_EXECUTOR_H
+#define PC_EXECUTOR_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <queue>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * A fixed pool of threads that runs tasks at given points in time.
+ * The tasks should not block, since a blocked task keeps one of the threads of the pool busy.
+ */
+class Executor
+{
+public:
+    using Task = std::function<void()>;
+
+    /**
+     * Constructor. It starts the threads of the pool.
+     *
+     * @param[in] numberOfThreads The number of threads of the pool.
+     */
+    explicit Executor(size_t numberOfThreads);
+
+    /**
+     * Destructor. It stops and joins the threads of the pool. The tasks that have not been run yet are discarded.
+     */
+    ~Executor();
+
+    Executor(const Executor&) = delete;
+
+    Executor& operator=(const Executor&) = delete;
+
+    /**
+     * Schedules 'task' to be run by a thread of the pool once 'time' is reached. The tasks due at the same time run in the order they were scheduled.
+     *
+     * @param[in] task The task.
+     * @param[in] time The point in time when the task is due.
+     */
+    void schedule(const Task& task, const std::chrono::steady_clock::time_point& time);
+
+    /**
+     * @return The executor shared by all the pooled actors of the process. It has one thread per core.
+     */
+    static Executor& getDefault();
+
+private:
+
+    /**
+     * A task and the point in time when it is due.
+     */
+    struct TimedTask
+    {
+        std::chrono::steady_clock::time_point time;
+        uint64_t sequence; //Orders the tasks due at the same time.
+        Task task;
+
+        bool operator>(const TimedTask& other) const;
+    };
+
+    /**
+     * The loop of each thread of the pool. It runs the due tasks until 'quitSignal_' is raised.
+     */
+    void run();
+
+    std::priority_queue<TimedTask, std::vector<TimedTask>, std::greater<TimedTask>> tasks_; //The pending tasks, the earliest first.
+    uint64_t sequence_; //The sequence of the next scheduled task.
+    std::vector<std::thread> threads_;
+    std::mutex mutex_; //Synchronizes accesses to 'tasks_', 'sequence_' and 'quitSignal_'.
+    std::condition_variable tasksCV_; //The threads of the pool wait on it until the earliest task is due.
+    bool quitSignal_;
+};
+
+#endif
@@ -0,0 +1,57 @@
+#ifndef PC_INLINE_SHARED_BUFFER_H
+#define PC_INLINE_SHARED_BUFFER_H
+
+#include <memory>
+#include "InlineItems.h"
+#include "sharedBuffer.h"
+
+/**
+ * A shared buffer whose items are stored contiguously in a vector of a concrete item type, instead of being pointers to 'IBufferItem'.
+ *
+ * The buffer does not know the type of the items: it fills and empties them with 'items_', which loops over each contiguous range of them
+ * without virtual dispatch. Each batch of items costs a virtual call to 'fillItems' or 'emptyItems' and one more for each of its ranges.
+ */
+class InlineSharedBuffer : public SharedBuffer
+{
+public:
+
+    /**
+     * Constructor
+     *
+     * @param[in/out] items The first of the items to produce and consume. They should outlive this buffer.
+     * @param[in] size The number of items.
+     * @param[in] operations The operations on the type of the items.
+     * @param[in] options The options of the buffer. 'options.backend' is ignored.
+     * @note Important!! All the items in the buffer should be empty, except the first ones, which are considered to be already produced.
+     */
+    InlineSharedBuffer(void* items, size_t size, std::unique_ptr<IInlineItems> operations, const BufferOptions& options);
+
+protected:
+
+    void fillItems(size_t first, size_t count) override;
+
+    void emptyItems(size_t first, size_t count) override;
+
+    void visitItems(size_t first, size_t count, const ItemVisitor& visitor) override;
+
+    bool isItemFilled(size_t index) const override;
+
+private:
+
+    /**
+     * @return The item of the slot 'index'.
+     */
+    void* getItem(size_t index) const;
+
+    /**
+     * Calls 'function' with the first item and the number of items of each contiguous range of the slots ['first', 'first' + 'count'),
+     * which are at most two.
+     */
+    template <class Function>
+    void forEachRange(size_t first, size_t count, Function function) const;
+
+    char* items_;
+    std::unique_ptr<IInlineItems> operations_;
+};
+
+#endif
@@ -3,92 +3,326 @@
 
 #include <vector>
 #include <mutex>
-#include "sharedBuffer.h"
+#include <list>
+#include <atomic>
+#include <unordered_map>
+#include <optional>
+#include <functional>
+#include <future>
+#include "ProducerConsumer.h"
+#include "ISharedBuffer.h"
+#include "IItemsBuffer.h"
 #include "producer.h"
 #include "consumer.h"
+#include "pooledActor.h"
+#include "coroutineActor.h"
+#include "awaitContext.h"
+#include "BufferAwaitable.h"
+#include "reaper.h"
+#include "threadCache.h"
+#include "actorAllocator.h"
 
 /**
- * Manages the additions and removals of producers and consumers.
+ * Manages the additions and removals of the producers and consumers of one buffer.
  */
 class ProducerConsumerManager
 {
 public:
-    using ProducerIterator = std::list<Producer* >::iterator;
-    using ConsumerIterator = std::list<Consumer* >::iterator;
+    ProducerConsumerManager();
+
+    /**
+     * Destructor. It stops the buffer, the producers and the consumers if 'stop' has not been called.
+     */
+    ~ProducerConsumerManager();
+
+    ProducerConsumerManager(const ProducerConsumerManager&) = delete;
+
+    ProducerConsumerManager& operator=(const ProducerConsumerManager&) = delete;
 
     /**
      * Sets the buffer that will be shared among producers and consumers. It also allow the internal buffer 'sharedBuffer_' to start accepting consumers and producers.
      *
      * @param[in] buffer The shared buffer.
+     * @param[in] options The options to create 'sharedBuffer_'.
+     * @note This method should be followed by a call to stop. Calling this method twice without a call to stop will cause undefined behaviour.
+     */
+    void start(const ProducerConsumer::ItemsBuffer& buffer, const BufferOptions& options);
+
+    /**
+     * Sets the buffer that will be shared among producers and consumers.
+     *
+     * @param[in] sharedBuffer The shared buffer. The manager takes its ownership and destroys it in 'stop'.
      * @note This method should be followed by a call to stop. Calling this method twice without a call to stop will cause undefined behaviour.
      */
-    static void start(const IPC::ItemsBuffer& buffer);
+    void start(ISharedBuffer* sharedBuffer);
+
+    /**
+     * Creates a buffer of 'IBufferItem' objects with the implementation selected in 'options'.
+     *
+     * @param[in] buffer The items of the buffer.
+     * @param[in] options The options of the buffer.
+     * @return The buffer. The caller takes its ownership.
+     */
+    static IItemsBuffer* createBuffer(const ProducerConsumer::ItemsBuffer& buffer, const BufferOptions& options);
 
     /**
      * Adds a producer to produce items into the buffer 'buffer_'.
      *
-     * @param[in] delay The delay the producer will take after producing an element.
+     * @param[in] options The options of the producer, like the delay it will take after producing an element, or whether it runs on the shared pool.
+     * @return The handle of the producer, or 0 if the buffer is stopped.
      */
-    static void addProducer(const std::chrono::milliseconds& delay);
+    ProducerConsumer::ActorHandle addProducer(const ActorOptions& options);
 
     /**
      * Adds a consumer to consume items from 'buffer_'.
      *
-     * @param[in] delay The delay the consumer will take after consuming an element.
+     * @param[in] options The options of the consumer, like the delay it will take after consuming an element, or whether it runs on the shared pool.
+     * @return The handle of the consumer, or 0 if the buffer is stopped.
+     */
+    ProducerConsumer::ActorHandle addConsumer(const ActorOptions& options);
+
+    /**
+     * Removes a consumer. The consumer is detached right away, and 'reaper_' waits for it to finish its current operation and destroys it.
+     *
+     * @return A future that becomes ready once the consumer is destroyed.
+     */
+    std::future<void> removeConsumer();
+
+    /**
+     * Removes a producer. The producer is detached right away, and 'reaper_' waits for it to finish its current operation and destroys it.
+     *
+     * @return A future that becomes ready once the producer is destroyed.
+     */
+    std::future<void> removeProducer();
+
+    /**
+     * Removes the producer or the consumer 'handle' as 'removeProducer' and 'removeConsumer' do.
+     *
+     * @param[in] handle The handle returned when the actor was added.
+     * @return A future that becomes ready once the actor is destroyed. It is ready right away if there is no actor with the handle.
+     */
+    std::future<void> remove(ProducerConsumer::ActorHandle handle);
+
+    /**
+     * Changes the delay of the producer or the consumer 'handle'.
+     *
+     * @param[in] handle The handle returned when the actor was added.
+     * @param[in] delay The new delay.
+     * @return false if there is no actor with the handle.
+     */
+    bool setDelay(ProducerConsumer::ActorHandle handle, const std::chrono::nanoseconds& delay);
+
+    /**
+     * @param[in] handle The handle returned when the actor was added.
+     * @return The statistics collected by the producer or the consumer 'handle', or nothing if there is no actor with the handle.
+     */
+    std::optional<ActorStatistics> getStatistics(ProducerConsumer::ActorHandle handle);
+
+    /**
+     * Removes all consumers and waits until they are destroyed. The quit signals of all of them are raised before waiting for any of them,
+     * and consumers can be added meanwhile.
      */
-    static void addConsumer(const std::chrono::milliseconds& delay);
+    void removeConsumers();
 
     /**
-     * Removes a consumer.
+     * Removes all producers and waits until they are destroyed. The quit signals of all of them are raised before waiting for any of them,
+     * and producers can be added meanwhile.
      */
-    static void removeConsumer();
+    void removeProducers();
 
     /**
-     * Removes a producer.
+     * Stops the shared buffer, the producers and the consumers. The quit signals of all the actors are raised, and the buffer is notified once,
+     * before waiting for any of them.
      */
-    static void removeProducer();
+    void stop();
 
     /**
-     * Removes all consumers.
+     * @param[in] count The maximum number of items to produce.
+     * @return An operation that a coroutine can await to produce up to 'count' items into the buffer. It completes without any item once 'stop' is called.
      */
-    static void removeConsumers();
+    BufferAwaitable produce(size_t count);
 
     /**
-     * Removes all producers.
+     * @param[in] count The maximum number of items to consume.
+     * @return An operation that a coroutine can await to consume up to 'count' items from the buffer. It completes without any item once 'stop' is called.
      */
-    static void removeProducers();
+    BufferAwaitable consume(size_t count);
 
     /**
-     * Stops the shared buffer, the producers and the consumers.
+     * Produces up to 'count' items from the calling thread, which is not an actor, without waiting.
+     *
+     * @param[in] count The maximum number of items to produce.
+     * @return The number of produced items. It is 0 if the buffer is full or stopped.
+     */
+    size_t tryProduce(size_t count);
+
+    /**
+     * Consumes up to 'count' items from the calling thread, which is not an actor, without waiting.
+     *
+     * @param[in] count The maximum number of items to consume.
+     * @return The number of consumed items. It is 0 if the buffer is empty or stopped.
+     */
+    size_t tryConsume(size_t count);
+
+    /**
+     * Produces up to 'count' items from the calling thread, which is not an actor, waiting until 'deadline' at most while the buffer is full.
+     * 'stop' wakes the call up.
+     *
+     * @param[in] count The maximum number of items to produce.
+     * @param[in] deadline The point in time when the call gives up.
+     * @return The number of produced items. It is 0 if the buffer is still full at 'deadline', or if it is stopped.
      */
-    static void stop();
+    size_t produceUntil(size_t count, const std::chrono::steady_clock::time_point& deadline);
 
     /**
-     * @return The index of the next item to be filled in the buffer.
+     * Consumes up to 'count' items from the calling thread, which is not an actor, waiting until 'deadline' at most while the buffer is empty.
+     * 'stop' wakes the call up.
+     *
+     * @param[in] count The maximum number of items to consume.
+     * @param[in] deadline The point in time when the call gives up.
+     * @return The number of consumed items. It is 0 if the buffer is still empty at 'deadline', or if it is stopped.
      */
-    static size_t getCurrentIndex() ;
+    size_t consumeUntil(size_t count, const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * @return The index of the next item to be filled in the buffer, or 0 if the manager is not started or it is stopped.
+     */
+    size_t getCurrentIndex();
+
+    /**
+     * @return The statistics collected by the buffer, or empty statistics if the manager is not started or it is stopped.
+     */
+    BufferStatistics getStatistics();
 
 private:
 
     /**
-     * Removes a consumer iterator from the 'consumers_' list. It also stops the 'Consumer' object associated with the itarator and frees its memory.
+     * An actor and its handle.
+     */
+    struct ManagedActor
+    {
+        ProducerConsumer::ActorHandle handle;
+        IActor* actor;
+    };
+
+    using ActorList = std::list<ManagedActor>; //The actors in the order they were added.
+    using ActorIndex = std::unordered_map<ProducerConsumer::ActorHandle, ActorList::iterator>; //Finds the actor of a handle in an 'ActorList'.
+
+    /**
+     * Creates a producer or a consumer of 'sharedBuffer_' that is executed as 'options.execution' says.
+     *
+     * @param[in] role Whether the actor produces or consumes items.
+     * @param[in] options The options of the actor.
+     * @return The actor, not started yet. The caller takes its ownership.
+     */
+    IActor* createActor(ActorRole role, const ActorOptions& options);
+
+    /**
+     * Calls 'visitor' with the producer or the consumer 'handle', while holding the mutex of its list.
+     *
+     * @param[in] handle The handle of the actor.
+     * @param[in] visitor The function to be called.
+     * @return false if there is no actor with the handle.
+     */
+    bool visit(ProducerConsumer::ActorHandle handle, const std::function<void(IActor&)>& visitor);
+
+    /**
+     * Removes a consumer from 'consumers_' and 'consumerIndex_', raises its quit signal and hands it to 'reaper_'.
+     *
+     * @param[in] consumerIterator The consumer to be removed.
+     * @return A future that becomes ready once the consumer is destroyed.
+     * @note 'mutexConsumers_' should be held by the caller.
+     */
+    std::future<void> removeConsumer(const ActorList::iterator& consumerIterator);
+
+    /**
+     * Removes a producer from 'producers_' and 'producerIndex_', raises its quit signal and hands it to 'reaper_'.
+     *
+     * @param[in] producerIterator The producer to be removed.
+     * @return A future that becomes ready once the producer is destroyed.
+     * @note 'mutexProducers_' should be held by the caller.
+     */
+    std::future<void> removeProducer(const ActorList::iterator& producerIterator);
+
+    /**
+     * @return A future that is already ready, for the removals that do not find any actor.
+     */
+    static std::future<void> destroyed();
+
+    /**
+     * Raises the quit signal of each actor of 'actors', without waiting for any of them.
+     *
+     * @param[in/out] actors The actors to be signaled.
+     */
+    static void requestStop(const ActorList& actors);
+
+    /**
+     * Waits for each actor of 'actors', whose quit signal is already raised, and frees its memory. The list and its index are left empty.
+     *
+     * @param[in/out] actors The actors to be destroyed.
+     * @param[in/out] index The index of 'actors'.
+     */
+    static void joinAndDelete(ActorList& actors, ActorIndex& index);
+
+    /**
+     * Calls 'operation' for a caller that is not an actor. 'awaitContext_' guards the buffer during the call, so 'stop' waits for it before
+     * destroying the buffer. Before the first call of each role, the buffer is told that it has external callers, so that it stops taking its
+     * single producer or single consumer path for good. The call does not take the mutexes of the actors.
+     *
+     * @param[in] role Whether the caller produces or consumes items.
+     * @param[in] operation Produces or consumes items in 'sharedBuffer_'.
+     * @return The number of items returned by 'operation', or 0 if the manager is stopped.
+     */
+    size_t callBuffer(ActorRole role, const std::function<size_t()>& operation);
+
+    /**
+     * Tells the buffer that it has external callers of 'role', as 'callBuffer' does, for the operations returned by 'produce' and 'consume',
+     * which call the buffer from the threads of the executor. Nothing is done if the manager is stopped.
+     *
+     * @param[in] role Whether the callers produce or consume items.
+     */
+    void addExternalCallers(ActorRole role);
+
+    /**
+     * Tells the buffer that it has external callers of 'role', unless it was already told since it was started.
+     *
+     * @param[in] role Whether the callers produce or consume items.
+     * @note 'awaitContext_' should be entered by the caller.
+     */
+    void markExternalCallers(ActorRole role);
+
+    /**
+     * Hands a consumer, already removed from 'consumers_' and whose quit signal is raised, to 'reaper_'.
      *
-     * @param[in/out] consumerIterator The consumer iterator to be destroyed.
+     * @param[in/out] consumer The consumer.
+     * @return A future that becomes ready once the consumer is destroyed.
+     * @note 'mutexConsumers_' should be held by the caller.
      */
-    static void removeConsumer(const ConsumerIterator& consumerIterator);
+    std::future<void> reapConsumer(IActor* consumer);
 
     /**
-     * Removes a producer iterator from the 'producers_' list. It also stops the 'Producer' object associated with the itarator and frees its memory.
+     * Hands a producer, already removed from 'producers_' and whose quit signal is raised, to 'reaper_'.
      *
-     * @param[in/out] producerIterator The producer iterator to be destroyed.
+     * @param[in/out] producer The producer.
+     * @return A future that becomes ready once the producer is destroyed.
+     * @note 'mutexProducers_' should be held by the caller.
      */
-    static void removeProducer(const ProducerIterator& producerIterator);
+    std::future<void> reapProducer(IActor* producer);
 
-    static SharedBuffer* sharedBuffer_;
-    static std::list<Consumer* > consumers_;
-    static std::list<Producer* > producers_;
-    static std::mutex mutexConsumers_; //Synchronizes accesses to 'consumers_'
-    static std::mutex mutexProducers_; //Synchronizes accesses to 'producers_'
+    ISharedBuffer* sharedBuffer_; //Null while the manager is not started.
+    std::shared_ptr<AwaitContext> awaitContext_; //Guards the accesses of the operations returned by 'produce' and 'consume'. It is cancelled while the manager is not started.
+    ActorList consumers_;
+    ActorList producers_;
+    ActorIndex consumerIndex_;
+    ActorIndex producerIndex_;
+    size_t removedConsumers_; //The consumers handed to 'reaper_' that are not destroyed yet.
+    size_t removedProducers_; //The producers handed to 'reaper_' that are not destroyed yet.
+    std::atomic<bool> externalConsumers_; //Whether 'tryConsume', 'consumeUntil' or 'consume' has been called since the buffer was started.
+    std::atomic<bool> externalProducers_; //Whether 'tryProduce', 'produceUntil' or 'produce' has been called since the buffer was started.
+    std::atomic<ProducerConsumer::ActorHandle> nextHandle_; //The handle of the next added actor.
+    std::mutex mutexConsumers_; //Synchronizes accesses to 'consumers_', 'consumerIndex_' and 'removedConsumers_'.
+    std::mutex mutexProducers_; //Synchronizes accesses to 'producers_', 'producerIndex_' and 'removedProducers_'.
+    Reaper reaper_; //Joins and destroys the removed actors.
 };
 
 #endif
\ No newline at end of file
@@ -0,0 +1,38 @@
+#ifndef PC_POINTER_SHARED_BUFFER_H
+#define PC_POINTER_SHARED_BUFFER_H
+
+#include <vector>
+#include "sharedBuffer.h"
+
+/**
+ * A shared buffer whose items are pointers to 'IBufferItem', so each of them can have its own type. The items are filled and emptied
+ * with a virtual call each.
+ */
+class PointerSharedBuffer : public SharedBuffer
+{
+public:
+
+    /**
+     * Constructor
+     *
+     * @param[int/out] buffer The buffer to produce and consume items.
+     * @param[in] options The options of the buffer, like the order in which the items are consumed.
+     * @note Important!! All the items in the buffer should be empty, except the first ones, which are considered to be already produced.
+     */
+    PointerSharedBuffer(const std::vector<IBufferItem*>& buffer, const BufferOptions& options);
+
+protected:
+
+    void fillItems(size_t first, size_t count) override;
+
+    void emptyItems(size_t first, size_t count) override;
+
+    void visitItems(size_t first, size_t count, const ItemVisitor& visitor) override;
+
+    bool isItemFilled(size_t index) const override;
+
+private:
+    std::vector<IBufferItem*> buffer_; //The items of the buffer.
+};
+
+#endif
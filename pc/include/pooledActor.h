@@ -0,0 +1,102 @@
+#ifndef PC_POOLED_ACTOR_H
+#define PC_POOLED_ACTOR_H
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "IActor.h"
+#include "executor.h"
+
+/**
+ * A producer or a consumer that runs as a task of an 'Executor' instead of on its own thread, so thousands of them can share a few threads.
+ *
+ * Each step produces or consumes up to 'batchSize' items without waiting, and then schedules the next step 'delay' later, or at the next
+ * deadline of a 'FIXED_RATE' actor, and not before the rate limiter of the actor lets the next items through.
+ * While the buffer is full (or empty for a consumer), no step is scheduled: the actor registers a waiter in the buffer, which schedules
+ * the next step once an item can be produced (or consumed), or once the buffer is notified or stopped.
+ */
+class PooledActor : public IActor
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] sharedBuffer The buffer with which this actor will interact.
+     * @param[in] role Whether this actor produces or consumes items.
+     * @param[in/out] executor The executor that will run the steps of this actor. It should outlive this actor.
+     */
+    PooledActor(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor);
+
+    /**
+     * Schedules the first step of this actor.
+     *
+     * @param[in] options The options of this actor.
+     */
+    void start(const ActorOptions& options) override;
+
+    /**
+     * Raises the quit signal. The steps already scheduled are discarded when they are due.
+     */
+    void requestStop() override;
+
+    /**
+     * Waits for the step being run, if any.
+     */
+    void join() override;
+
+    /**
+     * @return Whether this actor is running.
+     */
+    bool isRunning() const override;
+
+    /**
+     * Changes the delay this actor takes after producing or consuming items. It is applied from the next step.
+     *
+     * @param[in] delay The new delay.
+     */
+    void setDelay(const std::chrono::nanoseconds& delay) override;
+
+    /**
+     * @return The statistics collected by this actor.
+     */
+    ActorStatistics getStatistics() const override;
+
+private:
+
+    /**
+     * The state of the actor. The scheduled steps share it, so a step that is due after the actor is destroyed finds 'quitSignal' raised.
+     */
+    struct State
+    {
+        ISharedBuffer* sharedBuffer;
+        ActorRole role;
+        Executor& executor;
+        ActorOptions options;
+        ActorCounters counters; //The delay of the actor and its statistics.
+        ActorPacer pacer; //Computes the time of the step that follows a step that moved items.
+        bool quitSignal;
+        bool stepping; //Whether a thread of the executor is running a step.
+        std::mutex mutex; //Synchronizes accesses to 'quitSignal' and 'stepping'.
+        std::condition_variable stepCV; //'stop' waits on it until the running step finishes.
+    };
+
+    /**
+     * Produces or consumes up to 'options.batchSize' items and schedules the next step.
+     *
+     * @param[in/out] state The state of the actor.
+     */
+    static void step(const std::shared_ptr<State>& state);
+
+    /**
+     * Schedules the next step of the actor at 'time'.
+     *
+     * @param[in/out] state The state of the actor.
+     * @param[in] time The point in time when the step is due.
+     */
+    static void schedule(const std::shared_ptr<State>& state, const std::chrono::steady_clock::time_point& time);
+
+    std::shared_ptr<State> state_;
+};
+
+#endif
@@ -0,0 +1,102 @@
+#ifndef PC_POOLED_STAGE_WORKER_H
+#define PC_POOLED_STAGE_WORKER_H
+
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include "IActor.h"
+#include "executor.h"
+#include "stageWorker.h"
+
+/**
+ * A worker of a pipeline stage that runs as a task of an 'Executor' instead of on its own thread, as 'PooledActor' does for producers and consumers.
+ *
+ * Each step moves up to 'batchSize' items with 'PipelineStage::moveItems', which never waits, and then schedules the next step 'delay' later,
+ * or at the next deadline of a 'FIXED_RATE' worker, and not before the rate limiter of the worker lets the next items through. An item is only
+ * consumed from the input buffer while the output buffer has room for it, so a step never owns an item that it cannot move. While the input
+ * buffer is empty or the output buffer is full, no step is scheduled: the worker registers a waiter in that buffer, which schedules the next
+ * step once it is ready.
+ */
+class PooledStageWorker : public IActor
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] stage The stage of the worker. It should outlive the worker.
+     * @param[in/out] executor The executor that will run the steps of this worker. It should outlive this worker.
+     */
+    PooledStageWorker(PipelineStage& stage, Executor& executor);
+
+    /**
+     * Schedules the first step of this worker.
+     *
+     * @param[in] options The options of this worker.
+     */
+    void start(const ActorOptions& options) override;
+
+    /**
+     * Raises the quit signal. The steps already scheduled are discarded when they are due.
+     */
+    void requestStop() override;
+
+    /**
+     * Waits for the step being run, if any.
+     */
+    void join() override;
+
+    /**
+     * @return Whether this worker is running.
+     */
+    bool isRunning() const override;
+
+    /**
+     * Changes the delay this worker takes after moving items. It is applied from the next step.
+     *
+     * @param[in] delay The new delay.
+     */
+    void setDelay(const std::chrono::nanoseconds& delay) override;
+
+    /**
+     * @return The statistics collected by this worker.
+     */
+    ActorStatistics getStatistics() const override;
+
+private:
+
+    /**
+     * The state of the worker. The scheduled steps share it, so a step that is due after the worker is destroyed finds 'quitSignal' raised.
+     */
+    struct State
+    {
+        PipelineStage& stage;
+        Executor& executor;
+        ActorOptions options;
+        ActorCounters counters; //The delay of the worker and its statistics.
+        ActorPacer pacer; //Computes the time of the step that follows a step that moved items.
+        bool quitSignal;
+        bool stepping; //Whether a thread of the executor is running a step.
+        std::mutex mutex; //Synchronizes accesses to 'quitSignal' and 'stepping'.
+        std::condition_variable stepCV; //'stop' waits on it until the running step finishes.
+    };
+
+    /**
+     * Moves up to 'options.batchSize' items and schedules the next step.
+     *
+     * @param[in/out] state The state of the worker.
+     */
+    static void step(const std::shared_ptr<State>& state);
+
+    /**
+     * Schedules the next step of the worker at 'time'.
+     *
+     * @param[in/out] state The state of the worker.
+     * @param[in] time The point in time when the step is due.
+     */
+    static void schedule(const std::shared_ptr<State>& state, const std::chrono::steady_clock::time_point& time);
+
+    std::shared_ptr<State> state_;
+};
+
+#endif
@@ -16,7 +16,7 @@ public:
      *
      * @param[in/out] buffer The buffer where the producer will insert values.
      */
-    explicit Producer(SharedBuffer* buffer);
+    explicit Producer(ISharedBuffer* buffer);
 
 private:
 
@@ -24,9 +24,9 @@ private:
     /**
      * Starts adding elements to the buffer.
      *
-     * @param[in] delay The delay that the producer will take after producing one item.
+     * @param[in] options The options of the producer. Each time, the producer will produce up to 'options.batchSize' items and then wait 'options.delay', or the delay set later by 'setDelay'.
      */
-    void run(const std::chrono::milliseconds& delay) override;
+    void run(const ActorOptions& options) override;
 
 };
 
@@ -0,0 +1,70 @@
+#ifndef PC_REAPER_H
+#define PC_REAPER_H
+
+#include <deque>
+#include <functional>
+#include <future>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+#include "IActor.h"
+
+/**
+ * Joins and destroys removed actors on a thread of its own, so the caller of a removal does not wait for the actor to finish its current operation.
+ * The thread is started by the first call to 'reap'.
+ */
+class Reaper
+{
+public:
+    Reaper();
+
+    /**
+     * Destructor. It waits until all the actors handed to this object are destroyed.
+     */
+    ~Reaper();
+
+    Reaper(const Reaper&) = delete;
+
+    Reaper& operator=(const Reaper&) = delete;
+
+    /**
+     * Hands an actor to this object, which will join and destroy it.
+     *
+     * @param[in/out] actor The actor. Its quit signal should be raised by calling 'requestStop'. This object takes its ownership.
+     * @param[in] onDestroyed Called by the thread of this object right after the actor is destroyed, before the future becomes ready.
+     * @return A future that becomes ready once the actor is destroyed.
+     */
+    std::future<void> reap(IActor* actor, const std::function<void()>& onDestroyed);
+
+    /**
+     * Waits until all the actors handed to this object are destroyed.
+     */
+    void drain();
+
+private:
+
+    /**
+     * A removed actor and the promise of the future returned by 'reap'.
+     */
+    struct RemovedActor
+    {
+        IActor* actor;
+        std::function<void()> onDestroyed;
+        std::promise<void> destroyed;
+    };
+
+    /**
+     * The loop of 'thread_'. It joins and destroys the actors of 'actors_' until 'quitSignal_' is raised.
+     */
+    void run();
+
+    std::deque<RemovedActor> actors_; //The actors waiting to be destroyed.
+    size_t pending_; //The number of actors handed to this object that are not destroyed yet.
+    std::thread thread_;
+    bool quitSignal_;
+    std::mutex mutex_; //Synchronizes accesses to 'actors_', 'pending_', 'thread_' and 'quitSignal_'.
+    std::condition_variable actorsCV_; //'thread_' waits on it until there are actors to destroy.
+    std::condition_variable drainedCV_; //'drain' waits on it until 'pending_' is 0.
+};
+
+#endif
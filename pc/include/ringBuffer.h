@@ -0,0 +1,310 @@
+#ifndef PC_RING_BUFFER_H
+#define PC_RING_BUFFER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <vector>
+#include "IPCOptions.h"
+#include "IBufferItem.h"
+#include "IItemsBuffer.h"
+#include "eventSink.h"
+#include "waitStrategy.h"
+
+/**
+ * A lock-free bounded multi-producer/multi-consumer ring buffer.
+ *
+ * Each slot has a sequence number that tells whether the slot can be reserved by the producer or by the consumer of a given position.
+ * Producers reserve positions by advancing 'tail_' and consumers by advancing 'head_' with a compare and exchange, so the mutex 'mutex_'
+ * is only used to put actors to sleep while the buffer is full or empty. Producers sleep on 'notFullCV_' and consumers on 'notEmptyCV_',
+ * and each published item wakes up a single actor of the opposite role. Items can be published out of order, and the actors woken up for an item
+ * that is not the next one go back to sleep, so an actor that leaves slots it could reserve behind wakes up one more actor of its own role.
+ * The callers that do not block a thread register a waiter instead, which is called under 'mutex_' as a sleeping actor would be woken up.
+ * Items are produced and consumed in FIFO order.
+ *
+ * When there is only one producer, it owns 'tail_' and reserves positions without a compare and exchange, and the same applies
+ * to a single consumer and 'head_'. With one producer and one consumer the ring becomes a wait-free single-producer/single-consumer queue.
+ *
+ * When the overflow policy drops or overwrites the oldest items, a producer that finds the ring full reserves the oldest slots by advancing
+ * 'head_' as a consumer would, and keeps them by advancing 'tail_' too, so a dropped item is never lost to another producer.
+ * Since producers also advance 'head_', the single consumer path is never used.
+ */
+class RingBuffer : public IItemsBuffer
+{
+public:
+
+    /**
+     * Constructor
+     *
+     * @param[int/out] buffer The buffer to produce and consume items.
+     * @param[in] options The options of the buffer.
+     * @note Important!! All the items in the buffer should be empty, except the first ones, which are considered to be already produced.
+     * There should be 2 items at least, since the sequence of a released slot would be the one of an empty slot with a single slot.
+     */
+    RingBuffer(const std::vector<IBufferItem*>& buffer, const BufferOptions& options);
+
+    void produce(const IBufferActor* producer) override;
+
+    void consume(const IBufferActor* consumer) override;
+
+    size_t produceBatch(const IBufferActor* producer, size_t count) override;
+
+    size_t consumeBatch(const IBufferActor* consumer, size_t count) override;
+
+    size_t produceBatch(const IBufferActor* producer, size_t count, const ItemVisitor& fill) override;
+
+    size_t consumeBatch(const IBufferActor* consumer, size_t count, const ItemVisitor& empty) override;
+
+    size_t tryProduceBatch(size_t count) override;
+
+    size_t retryProduceBatch(size_t count) override;
+
+    size_t tryConsumeBatch(size_t count) override;
+
+    size_t tryConsumeBatch(size_t count, const ItemVisitor& empty) override;
+
+    size_t tryProduceBatch(size_t count, const ItemVisitor& fill) override;
+
+    bool isReady(ActorRole role) const override;
+
+    size_t produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    bool addWaiter(ActorRole role, const std::function<void()>& waiter) override;
+
+    void stop() override;
+
+    void notify() override;
+
+    bool isRunning() const override;
+
+    size_t getCurrentIndex() const override;
+
+    BufferStatistics getStatistics() const override;
+
+    IWaitStrategy& getWaitStrategy() override;
+
+    void setNumberOfProducers(size_t numberOfProducers) override;
+
+    void setNumberOfConsumers(size_t numberOfConsumers) override;
+
+    void addExternalCallers(ActorRole role) override;
+
+private:
+
+    /**
+     * A position of the ring.
+     * When 'sequence' is equal to the position of the slot, the slot is empty and can be reserved by a producer.
+     * When 'sequence' is equal to the position of the slot plus one, the slot is full and can be reserved by a consumer.
+     */
+    struct Slot
+    {
+        std::atomic<size_t> sequence;
+        IBufferItem* item;
+    };
+
+    /**
+     * A slot that takes a whole cache line, used with 'SlotLayout::PADDED'.
+     */
+    struct alignas(64) PaddedSlot: public Slot
+    {
+    };
+
+    /**
+     * Fills the items of the reserved slots starting at 'position' and publishes them to the consumers. Another producer is woken up first
+     * if the next slot can be reserved too.
+     *
+     * @param[in] position The position of the first reserved slot.
+     * @param[in] reserved The number of reserved slots.
+     * @param[in] fill Fills the items. When it is empty, 'IBufferItem::fill' is called.
+     * @return 'reserved'.
+     */
+    size_t publishProduced(size_t position, size_t reserved, const ItemVisitor& fill);
+
+    /**
+     * Empties the items of the reserved slots starting at 'position' and releases them to the producers. Another consumer is woken up first
+     * if the next slot can be reserved too.
+     *
+     * @param[in] position The position of the first reserved slot.
+     * @param[in] reserved The number of reserved slots.
+     * @param[in] empty Empties the items. When it is empty, 'IBufferItem::empty' is called.
+     * @return 'reserved'.
+     */
+    size_t publishConsumed(size_t position, size_t reserved, const ItemVisitor& empty);
+
+    /**
+     * Counts the consecutive slots, starting at 'position', that can be reserved.
+     *
+     * @param[in] position The first position.
+     * @param[in] count The maximum number of slots to count.
+     * @param[in] sequenceOffset The difference between the position and the sequence of a slot when it can be reserved.
+     * It is 0 for producers and 1 for consumers.
+     * @return The number of slots that can be reserved.
+     */
+    size_t countAvailable(size_t position, size_t count, size_t sequenceOffset) const;
+
+    /**
+     * Reserves up to 'count' consecutive slots by advancing 'index'. If 'single' is raised, 'index' is only modified by the calling thread
+     * and it is advanced without a compare and exchange.
+     *
+     * @param[in/out] index The index to be advanced, 'tail_' or 'head_'.
+     * @param[in] single The flag that enables the single producer or single consumer path.
+     * @param[out] inSinglePath The flag raised while the calling thread is using the single path.
+     * @param[out] position The first reserved position.
+     * @param[in] count The maximum number of slots to reserve.
+     * @param[in] sequenceOffset The difference between the position and the sequence of a slot when it can be reserved.
+     * @return The number of reserved slots, 0 if the buffer is full (for producers) or empty (for consumers).
+     */
+    size_t reserve(std::atomic<size_t>& index, const std::atomic<bool>& single, std::atomic<bool>& inSinglePath,
+                   size_t& position, size_t count, size_t sequenceOffset);
+
+    /**
+     * Disables the single producer or single consumer path, waiting for the thread that may be using it to leave it.
+     *
+     * @param[out] single The flag that enables the path, 'singleProducer_' or 'singleConsumer_'.
+     * @param[in] inSinglePath The flag raised while a thread is using the path.
+     */
+    static void disableSinglePath(std::atomic<bool>& single, const std::atomic<bool>& inSinglePath);
+
+    /**
+     * Enables or disables the single producer and the single consumer paths from the number of actors and the external callers.
+     *
+     * @note 'mutexSinglePaths_' should be held by the caller.
+     */
+    void updateSinglePaths();
+
+    /**
+     * Reserves up to 'count' consecutive slots for a producer. While the ring is full, it drops the oldest items if 'overflowPolicy_' allows it,
+     * and otherwise it counts the items that do not fit in 'droppedItems_' if 'overflowPolicy_' is 'REJECT'.
+     *
+     * @param[out] position The first reserved position.
+     * @param[in] count The maximum number of slots to reserve.
+     * @param[in] retried Whether the caller tries again with the items that do not fit, which are then not counted as rejected.
+     * @return The number of reserved slots, 0 if the ring is full and no item can be dropped.
+     */
+    size_t reserveToProduce(size_t& position, size_t count, bool retried);
+
+    /**
+     * Fills up to 'count' items without waiting, as 'tryProduceBatch' and 'retryProduceBatch' do.
+     *
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] fill Fills the reserved items. When it is empty, 'IBufferItem::fill' is called.
+     * @param[in] retried Whether the caller tries again with the items that do not fit, which are then not counted as rejected.
+     * @return The number of filled items, 0 if the ring is full or stopped.
+     */
+    size_t tryProduce(size_t count, const ItemVisitor& fill, bool retried);
+
+    /**
+     * Reserves up to 'count' of the oldest full slots while they are also the next slots at 'tail_', empties their items
+     * if 'overflowPolicy_' is 'DROP_OLDEST' and hands them directly to the producer by advancing 'head_' and 'tail_' past each of them.
+     * Since a dropped slot is never released to the other producers, each dropped item makes room for exactly one produced item.
+     *
+     * @param[out] position The first reserved position.
+     * @param[in] count The maximum number of items to drop.
+     * @return The number of dropped items and reserved slots, 0 if the slot at 'tail_' is still being emptied or the oldest item
+     *         is not published yet.
+     */
+    size_t dropOldest(size_t& position, size_t count);
+
+    /**
+     * @return Whether 'overflowPolicy_' drops the oldest items and the oldest item, which is published, is in the slot at 'tail_'.
+     */
+    bool canDropOldest() const;
+
+    /**
+     * @return Whether 'overflowPolicy_' drops or overwrites the oldest items when the ring is full.
+     */
+    bool dropsOldest() const;
+
+    /**
+     * @return Whether the slot at the position 'tail_' is empty.
+     */
+    bool canProduce() const;
+
+    /**
+     * @return Whether the slot at the position 'head_' is full.
+     */
+    bool canConsume() const;
+
+    /**
+     * Fills up to 'count' items as 'produceBatch' does with 'fill', waiting until 'deadline' at most while the buffer is full.
+     */
+    size_t produceBatchUntil(const IBufferActor* producer, size_t count, const ItemVisitor& fill, const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Empties up to 'count' items as 'consumeBatch' does with 'empty', waiting until 'deadline' at most while the buffer is empty.
+     */
+    size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const ItemVisitor& empty, const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Waits on 'conditionVariable' with 'waitStrategy_' until 'ready' returns true or until 'deadline'. The wakeups after which 'ready' is still
+     * false are counted in 'parkedSpuriousWakeups_'.
+     *
+     * @param[in/out] conditionVariable The condition variable to wait on, 'notFullCV_' or 'notEmptyCV_'.
+     * @param[in/out] waiters The number of threads waiting on 'conditionVariable'.
+     * @param[in] ready The condition to wait for.
+     * @param[in] deadline The point in time when the wait gives up.
+     * @return The last value returned by 'ready'.
+     */
+    bool wait(std::condition_variable& conditionVariable, std::atomic<size_t>& waiters, const std::function<bool()>& ready,
+              const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Calls one registered waiter and wakes up one thread blocked on 'conditionVariable' for each published item, if there is any.
+     *
+     * @param[in/out] conditionVariable The condition variable to notify.
+     * @param[in/out] waiters The number of threads waiting on 'conditionVariable' plus the number of registered waiters.
+     * @param[in/out] registeredWaiters The registered waiters of the same role. The called ones are removed.
+     * @param[in] items The number of published items.
+     */
+    void wakeWaiters(std::condition_variable& conditionVariable, std::atomic<size_t>& waiters, std::deque<std::function<void()>>& registeredWaiters,
+                     size_t items);
+
+    /**
+     * Calls and removes all the registered waiters.
+     *
+     * @note 'mutex_' should be held by the caller.
+     */
+    void callRegisteredWaiters();
+
+    /**
+     * @return The slot of 'position'.
+     */
+    Slot& getSlot(size_t position) const;
+
+    alignas(64) std::atomic<size_t> head_; //The position of the next item to be consumed.
+    std::atomic<bool> singleConsumer_; //Whether there is only one consumer, which owns 'head_'.
+    std::atomic<bool> consumerInSinglePath_; //Raised while the single consumer is reserving a position.
+    alignas(64) std::atomic<size_t> tail_; //The position of the next item to be produced.
+    std::atomic<bool> singleProducer_; //Whether there is only one producer, which owns 'tail_'.
+    std::atomic<bool> producerInSinglePath_; //Raised while the single producer is reserving a position.
+    size_t numberOfConsumers_; //The number set by 'setNumberOfConsumers'.
+    size_t numberOfProducers_; //The number set by 'setNumberOfProducers'.
+    bool externalConsumers_; //Whether threads that are not actors consume items too.
+    bool externalProducers_; //Whether threads that are not actors produce items too.
+    std::mutex mutexSinglePaths_; //Synchronizes the changes of the single paths, and accesses to the numbers of actors and the external callers.
+    alignas(64) std::atomic<size_t> notFullWaiters_; //The number of producers sleeping in 'wait' plus the number of 'notFullRegisteredWaiters_'.
+    alignas(64) std::atomic<size_t> notEmptyWaiters_; //The number of consumers sleeping in 'wait' plus the number of 'notEmptyRegisteredWaiters_'.
+    alignas(64) std::atomic<size_t> spuriousWakeups_; //The number of woken up actors that could not reserve a slot.
+    std::atomic<size_t> droppedItems_; //The number of items rejected, dropped or overwritten by 'overflowPolicy_'.
+    std::atomic<bool> quitSignal_;
+    size_t capacity_;
+    OverflowPolicy overflowPolicy_;
+    std::unique_ptr<Slot[]> slots_; //The slots of a 'SlotLayout::COMPACT' buffer.
+    std::unique_ptr<PaddedSlot[]> paddedSlots_; //The slots of a 'SlotLayout::PADDED' buffer.
+    NullEventSink nullEventSink_; //The sink used when 'options.eventSink' is null.
+    IBufferEventSink* eventSink_;
+    std::unique_ptr<IWaitStrategy> waitStrategy_;
+    size_t parkedSpuriousWakeups_; //The number of spurious wakeups while waiting in 'wait'. Protected by 'mutex_'.
+    mutable std::mutex mutex_; //To put producers and consumers to sleep while the buffer is full or empty.
+    std::condition_variable notFullCV_;
+    std::condition_variable notEmptyCV_;
+    std::deque<std::function<void()>> notFullRegisteredWaiters_; //The waiters registered by producers. Protected by 'mutex_'.
+    std::deque<std::function<void()>> notEmptyRegisteredWaiters_; //The waiters registered by consumers. Protected by 'mutex_'.
+};
+
+#endif
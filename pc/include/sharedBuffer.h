@@ -1,81 +1,231 @@
 #ifndef PC_SHARED_BUFFER_H
 #define PC_SHARED_BUFFER_H
 
+#include <atomic>
 #include <mutex>
 #include <condition_variable>
 #include <vector>
 #include <list>
 #include <chrono>
-#include "IPC.h"
+#include <functional>
+#include "IPCOptions.h"
 #include "IBufferItem.h"
-
-class Producer;
-class Consumer;
+#include "IItemsBuffer.h"
+#include "eventSink.h"
+#include "waitStrategy.h"
+#include "slotQueue.h"
 
 /**
  * Class that represents the shared buffer between producers and consumers.
- * 
+ * The slots of the buffer are reserved while holding a mutex by 'queue_' (see 'SlotQueue'). Producers wait on 'notFullCV_' when the buffer
+ * is full and consumers wait on 'notEmptyCV_' when it is empty, with the wait strategy of the options.
+ * The items are stored by the derived classes, which fill and empty them: 'PointerSharedBuffer' for pointers to 'IBufferItem' and
+ * 'InlineSharedBuffer' for items of a concrete type.
  */
-class SharedBuffer
+class SharedBuffer : public IItemsBuffer
 {
 public:
 
     /**
-     * Constructor
+     * Adds an element to the buffer in the 'getProduceSlot()' position and increases 'currentIndex_'. This is the producer role.
+     * The slot is reserved under 'mutex_', but the item is filled without holding it, so several producers and consumers can
+     * work on different items at the same time.
      *
-     * @param[int/out] buffer The buffer to produce and consume items. 
-     * @note Important!! All the items in the buffer should be empty.
+     * @param[in] producer The producer.
+     * @note If the buffer is full, this call will block until a consumer consumes an item.
+     */
+    void produce(const IBufferActor* producer) override;
+
+    /**
+     * Extracts the element in the 'getConsumeSlot()' position from the buffer and decreases 'currentIndex_'. This is the consumer role.
+     * As in 'produce', the item is emptied without holding 'mutex_'.
+     *
+     * @param[in] consumer The consumer.
+     * @note If the buffer is empty, this call will block until a producer produces an item.
      */
-    explicit SharedBuffer(const IPC::ItemsBuffer& buffer);
+    void consume(const IBufferActor* consumer) override;
 
     /**
-     * Adds an element to the buffer in the 'currentIndex_' position and increases 'currentIndex_'. This is the producer role.
+     * Reserves up to 'count' consecutive slots while holding 'mutex_' once, fills their items without holding it and publishes all of them
+     * with a single notification.
      *
      * @param[in] producer The producer.
-     * @note If the buffer is full, this call will block until a consumer consumes an item.
+     * @param[in] count The maximum number of items to fill.
+     * @return The number of filled items.
      */
-    void produce(const Producer* producer);
+    size_t produceBatch(const IBufferActor* producer, size_t count) override;
 
     /**
-     * Extracts the element 'currentIndex_' from the buffer and decreases 'currentIndex_'. This is the consumer role.
+     * Reserves up to 'count' consecutive slots while holding 'mutex_' once, empties their items without holding it and publishes all of them
+     * with a single notification.
      *
      * @param[in] consumer The consumer.
-     * @note If the buffer is empty, this call will block until a producer produces an item.
+     * @param[in] count The maximum number of items to empty.
+     * @return The number of emptied items.
+     */
+    size_t consumeBatch(const IBufferActor* consumer, size_t count) override;
+
+    /**
+     * @note Only the items that are an 'IBufferItem' can be visited, so 'fill' should be empty for the other ones.
      */
-    void consume(const Consumer* consumer);
+    size_t produceBatch(const IBufferActor* producer, size_t count, const ItemVisitor& fill) override;
+
+    /**
+     * @note Only the items that are an 'IBufferItem' can be visited, so 'empty' should be empty for the other ones.
+     */
+    size_t consumeBatch(const IBufferActor* consumer, size_t count, const ItemVisitor& empty) override;
+
+    size_t tryProduceBatch(size_t count) override;
+
+    size_t retryProduceBatch(size_t count) override;
+
+    size_t tryConsumeBatch(size_t count) override;
+
+    size_t tryConsumeBatch(size_t count, const ItemVisitor& empty) override;
 
     /**
-     * Stops the buffer from accepting and/or returning elements.
+     * @note Only the items that are an 'IBufferItem' can be visited, so 'fill' should be empty for the other ones.
      */
-    void stop();
+    size_t tryProduceBatch(size_t count, const ItemVisitor& fill) override;
+
+    bool isReady(ActorRole role) const override;
+
+    size_t produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    bool addWaiter(ActorRole role, const std::function<void()>& waiter) override;
+
+    void stop() override;
+
+    void notify() override;
+
+    bool isRunning() const override;
+
+    size_t getCurrentIndex() const override;
+
+    BufferStatistics getStatistics() const override;
+
+    IWaitStrategy& getWaitStrategy() override;
+
+protected:
 
     /**
-     * Notifies that an external event happened. An example of an external event is the removal of a producer or a consumer.
+     * Constructor. The derived class should call 'calculateCurrentIndex' once its items are ready.
+     *
+     * @param[in] size The number of items of the buffer.
+     * @param[in] options The options of the buffer, like the order in which the items are consumed.
      */
-    void notify();
+    SharedBuffer(size_t size, const BufferOptions& options);
 
     /**
-     * Whether producers and consumers can produce and consume elements respectively.
+     * Fills the items of the slots ['first', 'first' + 'count'), wrapping around the end of the buffer.
+     *
+     * @param[in] first The slot of the first item.
+     * @param[in] count The number of items to fill.
      */
-    bool isRunning() const;
+    virtual void fillItems(size_t first, size_t count) = 0;
 
     /**
-     * @return The index of the next item to be filled in the buffer.
+     * Empties the items of the slots ['first', 'first' + 'count'), wrapping around the end of the buffer.
+     *
+     * @param[in] first The slot of the first item.
+     * @param[in] count The number of items to empty.
      */
-    size_t getCurrentIndex() const;
+    virtual void emptyItems(size_t first, size_t count) = 0;
 
-private:
+    /**
+     * Calls 'visitor' for the items of the slots ['first', 'first' + 'count'), wrapping around the end of the buffer.
+     *
+     * @param[in] first The slot of the first item.
+     * @param[in] count The number of items to visit.
+     * @param[in] visitor Fills or empties each item.
+     */
+    virtual void visitItems(size_t first, size_t count, const ItemVisitor& visitor) = 0;
 
     /**
-     * Calculates the current index based on the last filled item on 'buffer_'.
+     * @param[in] index The slot of the item.
+     * @return Whether the item of the slot 'index' is filled.
+     */
+    virtual bool isItemFilled(size_t index) const = 0;
+
+    /**
+     * Calculates the current index based on the last filled item of the buffer. It also initializes 'slots_'.
      */
     void calculateCurrentIndex();
 
-    size_t currentIndex_; //The index of the next item to be produced.
-    IPC::ItemsBuffer buffer_;
-    mutable std::mutex mutex_; //To synchornize accesses to 'currentIndex_' and 'buffer_'.
-    std::condition_variable quitCV_;
-    bool quitSignal_;
+    /**
+     * @return The index of the slot placed 'offset' positions after the slot 'first', wrapping around the end of the buffer.
+     */
+    size_t getSlot(size_t first, size_t offset) const;
+
+    size_t size_; //The number of items of the buffer.
+
+private:
+
+    /**
+     * A slot of the buffer. The slots of a buffer of a single process do not need an owner.
+     */
+    struct Slot
+    {
+        SlotState state;
+    };
+
+    /**
+     * Adapts a condition variable to 'SlotQueue', waiting on it with the wait strategy of the buffer.
+     */
+    class ConditionVariable
+    {
+    public:
+        explicit ConditionVariable(IWaitStrategy& waitStrategy);
+
+        bool wait(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, const std::function<bool()>& probe,
+                  const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups);
+
+        void notifyOne();
+
+        void notifyAll();
+
+        bool parksThreads() const;
+
+    private:
+        IWaitStrategy& waitStrategy_;
+        std::condition_variable conditionVariable_;
+    };
+
+    /**
+     * Fills up to 'count' items as 'produceBatch' does with 'fill', waiting until 'deadline' at most while the buffer is full.
+     */
+    size_t produceBatchUntil(const IBufferActor* producer, size_t count, const ItemVisitor& fill, const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Empties up to 'count' items as 'consumeBatch' does with 'empty', waiting until 'deadline' at most while the buffer is empty.
+     */
+    size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const ItemVisitor& empty, const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Fills the items of the slots ['first', 'first' + 'count') with 'fill', or with 'fillItems' when 'fill' is empty.
+     */
+    void fillSlots(size_t first, size_t count, const ItemVisitor& fill);
+
+    /**
+     * Empties the items of the slots ['first', 'first' + 'count') with 'empty', or with 'emptyItems' when 'empty' is empty.
+     */
+    void emptySlots(size_t first, size_t count, const ItemVisitor& empty);
+
+    //The members below are only read after construction, so they can be cached by every core at the same time.
+    NullEventSink nullEventSink_; //The sink used when 'options.eventSink' is null.
+    IBufferEventSink* eventSink_;
+    std::unique_ptr<IWaitStrategy> waitStrategy_;
+
+    //The members below are written under 'mutex_' by every producer and consumer. They start on their own cache line, so that
+    //writing them does not invalidate the read-only members above.
+    alignas(64) mutable std::mutex mutex_; //To synchornize accesses to 'indices_' and 'slots_'.
+    SlotIndices indices_;
+    std::vector<Slot> slots_; //The state of each item of the buffer.
+    ConditionVariable notFullCV_; //Producers wait on it while the buffer is full.
+    ConditionVariable notEmptyCV_; //Consumers wait on it while the buffer is empty.
+    SlotQueue<std::mutex, ConditionVariable, Slot> queue_;
 };
 
 #endif
\ No newline at end of file
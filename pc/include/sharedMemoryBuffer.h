@@ -0,0 +1,435 @@
+#ifndef PC_SHARED_MEMORY_BUFFER_H
+#define PC_SHARED_MEMORY_BUFFER_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <new>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <functional>
+#include <algorithm>
+#include <array>
+#include <type_traits>
+#include <pthread.h>
+#include <sys/types.h>
+#include "IPCOptions.h"
+#include "InlineItems.h"
+#include "ISharedBuffer.h"
+#include "eventSink.h"
+#include "waitStrategy.h"
+#include "slotQueue.h"
+
+/**
+ * A buffer whose slots, indices and synchronization live in a named POSIX shared memory segment, so that producers and consumers of different
+ * processes can share it. One process creates the segment and the others attach to it by its name.
+ * The slots are reserved by 'queue_', with the same algorithm as 'SharedBuffer' (see 'SlotQueue').
+ * The indices and the state of the slots are protected by a process-shared mutex, and the actors waiting while the buffer is full or empty
+ * sleep on process-shared condition variables, whatever the wait strategy is. The wait strategy is only used by the actors to rest.
+ * The stop signal is local to each process: stopping the buffer of one process does not stop the actors of the others.
+ * The registered waiters are local to each process too. The items published by the actors of this process call them, and since the other
+ * processes cannot call them, they are also called every 'RECOVERY_INTERVAL' while there is any.
+ *
+ * A process can die at any moment, even while it is filling or emptying an item. Each attached process has a record in the header, with its pid,
+ * its start time and its pid namespace, and each reserved slot is stamped with the record of the process that owns it. A process is dead when
+ * its pid does not exist anymore, is a zombie or belongs to a process started at another time, so a reused pid is not taken for the owner.
+ * The slots owned by dead processes are reclaimed: a half-emptied item is reset and returned to the producers, and a half-filled item is
+ * reset and discarded by the next consumer. Every 'RECOVERY_INTERVAL', one waiting or failed actor of each process checks the records without
+ * holding the mutex, and the slots are only scanned when an owner died. The mutex is robust, so a process that dies while holding it does not
+ * block the others.
+ * The pid of a process of another pid namespace cannot be checked, so its slots are only reclaimed by the processes of its namespace,
+ * and without a mounted /proc no process is found dead. At most 'MAX_OWNERS' buffers can be attached to a segment at the same time.
+ * This class does not know the type of the items, which are filled and emptied by the derived class.
+ * The overflow policy is also local to each process, and only 'OverflowPolicy::BLOCK' and 'OverflowPolicy::REJECT' are supported.
+ */
+class SharedMemoryBuffer: public ISharedBuffer
+{
+public:
+
+    void produce(const IBufferActor* producer) override;
+
+    void consume(const IBufferActor* consumer) override;
+
+    size_t produceBatch(const IBufferActor* producer, size_t count) override;
+
+    size_t consumeBatch(const IBufferActor* consumer, size_t count) override;
+
+    size_t tryProduceBatch(size_t count) override;
+
+    size_t retryProduceBatch(size_t count) override;
+
+    size_t tryConsumeBatch(size_t count) override;
+
+    size_t produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    size_t consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline) override;
+
+    bool addWaiter(ActorRole role, const std::function<void()>& waiter) override;
+
+    void stop() override;
+
+    void notify() override;
+
+    bool isRunning() const override;
+
+    size_t getCurrentIndex() const override;
+
+    BufferStatistics getStatistics() const override;
+
+    IWaitStrategy& getWaitStrategy() override;
+
+    /**
+     * Destructor. It unmaps the segment, and removes its name if this buffer created it. The processes already attached can still use it.
+     */
+    virtual ~SharedMemoryBuffer();
+
+protected:
+
+    /**
+     * Constructor. The segment is created or attached later with 'createSegment' or 'attachSegment'.
+     *
+     * @param[in] options The options of the buffer. 'options.backend' and 'options.slotLayout' are ignored.
+     */
+    explicit SharedMemoryBuffer(const BufferOptions& options);
+
+    /**
+     * Creates the segment 'name' and maps it.
+     *
+     * @param[in] name The name of the segment, like "/myBuffer".
+     * @param[in] size The number of items of the buffer.
+     * @param[in] itemSize The size of each item, in bytes.
+     * @return false if the segment already exists, it could not be created or the overflow policy is not supported.
+     * @note The items are not initialized. The derived class should initialize them before other processes attach to the segment,
+     * and then call 'publishSegment'.
+     */
+    bool createSegment(const std::string& name, size_t size, size_t itemSize);
+
+    /**
+     * Makes the segment created by 'createSegment' visible to 'attachSegment'.
+     */
+    void publishSegment();
+
+    /**
+     * Attaches to the segment 'name', created by another buffer.
+     *
+     * @param[in] name The name of the segment.
+     * @param[in] itemSize The size of each item, in bytes. It should be the one used to create the segment.
+     * @return false if the segment does not exist, it has not been published yet, it was created for items of another size
+     * or the overflow policy is not supported.
+     */
+    bool attachSegment(const std::string& name, size_t itemSize);
+
+    /**
+     * Fills the items of the slots ['first', 'first' + 'count'), wrapping around the end of the buffer.
+     */
+    virtual void fillItems(size_t first, size_t count) = 0;
+
+    /**
+     * Empties the items of the slots ['first', 'first' + 'count'), wrapping around the end of the buffer.
+     */
+    virtual void emptyItems(size_t first, size_t count) = 0;
+
+    /**
+     * Resets the item of the slot 'index' to an empty item, discarding what a dead process left in it.
+     */
+    virtual void resetItem(size_t index) = 0;
+
+    /**
+     * @return The first item of the segment.
+     */
+    void* getItems() const;
+
+    /**
+     * @return The number of items of the buffer.
+     */
+    size_t getSize() const;
+
+private:
+
+    /**
+     * A slot of the buffer. The slots are stored in the segment after the header.
+     */
+    struct Slot
+    {
+        SlotState state;
+        uint32_t owner; //The record in 'Header::owners' of the process that reserved the slot while it is 'FILLING' or 'EMPTYING'.
+    };
+
+    /**
+     * The identity of a process attached to the segment.
+     */
+    struct Owner
+    {
+        pid_t pid; //0 while the record is free.
+        uint64_t startTime; //When the process started, in clock ticks after boot.
+        uint64_t pidNamespace; //The inode of the pid namespace in which 'pid' is valid, or 0 if it is not known.
+    };
+
+    static constexpr size_t MAX_OWNERS = 64; //The number of buffers that can be attached to a segment at the same time.
+
+    using DeadOwners = std::array<bool, MAX_OWNERS>;
+
+    /**
+     * The header of the segment. It is followed by the slots and then by the items.
+     */
+    struct Header
+    {
+        std::atomic<uint64_t> magic; //Set to 'MAGIC' once the segment is initialized.
+        size_t size; //The number of items.
+        size_t itemSize;
+        size_t itemsOffset; //The offset of the first item from the beginning of the segment.
+        BufferOrdering ordering;
+        pthread_mutex_t mutex; //To synchronize accesses to the members below and to the state of the slots.
+        pthread_cond_t notFullCV; //Producers wait on it while the buffer is full.
+        pthread_cond_t notEmptyCV; //Consumers wait on it while the buffer is empty.
+        SlotIndices indices; //The waiters are the ones of all processes.
+        size_t recoveredSlots; //The number of slots reclaimed from dead processes.
+        Owner owners[MAX_OWNERS]; //The processes attached to the segment.
+    };
+
+    /**
+     * Adapts the process-shared mutex of the segment to be used with 'std::unique_lock' and 'std::scoped_lock'.
+     * When the previous owner of the mutex died while holding it, the slots of the dead processes are recovered before returning.
+     */
+    class SegmentMutex
+    {
+    public:
+        explicit SegmentMutex(SharedMemoryBuffer& buffer);
+
+        void lock();
+
+        void unlock();
+
+    private:
+        SharedMemoryBuffer& buffer_;
+    };
+
+    /**
+     * Adapts a process-shared condition variable of the segment to 'SlotQueue'. The waiting threads always sleep, whatever the wait strategy is,
+     * and they wake up every 'RECOVERY_INTERVAL' to recover the slots owned by dead processes, since those slots may be what they are waiting for.
+     */
+    class SegmentConditionVariable
+    {
+    public:
+
+        /**
+         * Constructor.
+         *
+         * @param[in/out] buffer The buffer of the segment.
+         * @param[in] conditionVariable The condition variable of the header, 'Header::notFullCV' or 'Header::notEmptyCV'.
+         */
+        SegmentConditionVariable(SharedMemoryBuffer& buffer, pthread_cond_t Header::* conditionVariable);
+
+        bool wait(std::unique_lock<SegmentMutex>& lock, const std::function<bool()>& ready, const std::function<bool()>& probe,
+                  const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups);
+
+        void notifyOne();
+
+        void notifyAll();
+
+        bool parksThreads() const;
+
+    private:
+        SharedMemoryBuffer& buffer_;
+        pthread_cond_t Header::* conditionVariable_;
+    };
+
+    static constexpr uint64_t MAGIC = 0x5043534842554634; //"PCSHBUF4"
+    static constexpr std::chrono::milliseconds RECOVERY_INTERVAL{100}; //How often each process looks for slots owned by dead processes.
+
+    /**
+     * Reads the start time of the process 'pid' from /proc.
+     *
+     * @param[in] pid The process, in the pid namespace of this process.
+     * @param[out] startTime When the process started, in clock ticks after boot.
+     * @return false if the process does not exist or is a zombie.
+     */
+    static bool readStartTime(pid_t pid, uint64_t& startTime);
+
+    /**
+     * @return The inode of the pid namespace of this process, or 0 if /proc is not mounted.
+     */
+    static uint64_t readPidNamespace();
+
+    /**
+     * @return The identity of this process, with a 0 pid namespace if its start time cannot be read.
+     */
+    static Owner readSelf();
+
+    /**
+     * The state shared by the buffer and the task of 'Executor' that calls its registered waiters, which may be due after the buffer is destroyed.
+     */
+    struct WaiterTimer
+    {
+        SharedMemoryBuffer* buffer; //Null once the buffer is destroyed.
+        bool scheduled; //Whether the task is scheduled.
+        std::mutex mutex; //Synchronizes accesses to the members above.
+    };
+
+    /**
+     * Schedules the task that calls the registered waiters after 'RECOVERY_INTERVAL', unless it is already scheduled.
+     */
+    void scheduleWaiterTimer();
+
+    /**
+     * Maps 'segmentSize_' bytes of the open segment 'fd'.
+     *
+     * @return false if the segment could not be mapped.
+     */
+    bool mapSegment(int fd);
+
+    /**
+     * Checks the header of a segment created by another process, before trusting its sizes.
+     *
+     * @param[in] itemSize The size of each item, in bytes.
+     * @return Whether the segment is initialized for items of 'itemSize' bytes, and its slots and items fit in the 'segmentSize_' mapped bytes.
+     */
+    bool isSegmentValid(size_t itemSize) const;
+
+    /**
+     * Hands the slots, the indices and the synchronization of the mapped segment to 'queue_'.
+     */
+    void attachQueue();
+
+    /**
+     * @return The slots, stored in the segment after the header.
+     */
+    Slot* getSlots() const;
+
+    /**
+     * Takes a free record of 'Header::owners' for this process, after recovering the records of the dead processes if none is free.
+     *
+     * @return false if 'MAX_OWNERS' live buffers are attached to the segment.
+     * @note The segment mutex should be held by the caller.
+     */
+    bool registerOwner();
+
+    /**
+     * @return Whether the process of 'owner' may still be running. The processes of other pid namespaces cannot be checked, so they are.
+     */
+    bool isAlive(const Owner& owner) const;
+
+    /**
+     * Fills up to 'count' items without waiting, as 'tryProduceBatch' and 'retryProduceBatch' do, and looks for dead owners if the buffer is
+     * full and it is time to.
+     *
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] retried Whether the caller tries again with the items that do not fit, which are then not counted as rejected.
+     * @return The number of filled items.
+     */
+    size_t tryProduce(size_t count, bool retried);
+
+    /**
+     * @return Whether it is time for this process to look for dead owners. Only one thread of the process is told so every 'RECOVERY_INTERVAL'.
+     */
+    bool isRecoveryDue();
+
+    /**
+     * Reclaims the slots reserved by processes that do not exist anymore, checking them while holding the segment mutex.
+     * It is used when the previous owner of the mutex died, before the segment is made consistent again.
+     *
+     * @note The segment mutex should be held by the caller.
+     */
+    void recoverSlots();
+
+    /**
+     * Reclaims the slots reserved by processes that do not exist anymore. 'lock' is released while the records are checked in /proc.
+     *
+     * @param[in/out] lock The lock of the segment mutex, held before and after the call.
+     */
+    void recoverSlots(std::unique_lock<SegmentMutex>& lock);
+
+    /**
+     * Reclaims the slots of the owners found dead in 'owners', a copy of 'Header::owners', and frees their records. The records that changed
+     * since the copy was taken belong to other processes, and are left alone. The actors waiting for the reclaimed slots are woken up.
+     *
+     * @note The segment mutex should be held by the caller.
+     */
+    void reclaimSlots(const Owner* owners, const DeadOwners& dead);
+
+    /**
+     * @return Whether this buffer can use 'overflowPolicy_'. The items of a shared memory buffer are never dropped nor overwritten.
+     */
+    bool isOverflowPolicySupported() const;
+
+    NullEventSink nullEventSink_; //The sink used when 'options.eventSink' is null.
+    IBufferEventSink* eventSink_;
+    std::unique_ptr<IWaitStrategy> waitStrategy_;
+    BufferOrdering ordering_; //The ordering of the segment, when this buffer creates it.
+    OverflowPolicy overflowPolicy_; //What the producers of this process do when the buffer is full.
+    Owner self_; //The identity of this process.
+    size_t ownerIndex_; //The record of this buffer in 'Header::owners', which stamps the slots it reserves, or 'MAX_OWNERS' if it has none.
+    std::atomic<std::chrono::steady_clock::rep> lastRecovery_; //When this process last looked for dead owners.
+    std::string name_; //The name of the segment.
+    bool owner_; //Whether this buffer created the segment, and so it removes its name when it is destroyed.
+    size_t segmentSize_;
+    Header* header_; //The mapped segment.
+    mutable SegmentMutex mutex_;
+    SegmentConditionVariable notFullCV_;
+    SegmentConditionVariable notEmptyCV_;
+    SlotQueue<SegmentMutex, SegmentConditionVariable, Slot> queue_; //Its statistics are the ones of the actors of this process.
+    std::shared_ptr<WaiterTimer> waiterTimer_;
+};
+
+/**
+ * A shared memory buffer of items stored inline in the segment. It does not know the type of the items either, and it fills and empties them
+ * with 'operations_', once for each contiguous range of the segment.
+ * The items should be trivially copyable, so they cannot have virtual methods nor pointers to the memory of a process, and a default constructed
+ * item should be empty.
+ */
+class InlineSharedMemoryBuffer: public SharedMemoryBuffer
+{
+public:
+
+    /**
+     * Creates the segment 'name' with 'size' empty items.
+     *
+     * @param[in] name The name of the segment, like "/myBuffer".
+     * @param[in] size The number of items of the buffer.
+     * @param[in] operations The operations on the type of the items.
+     * @param[in] options The options of the buffer.
+     * @return The buffer, or null if the segment already exists, it could not be created or 'options.overflowPolicy' drops or overwrites items.
+     */
+    static std::unique_ptr<InlineSharedMemoryBuffer> create(const std::string& name, size_t size, std::unique_ptr<IInlineItems> operations,
+                                                            const BufferOptions& options);
+
+    /**
+     * Attaches to the segment 'name', created by 'create' in this or another process.
+     *
+     * @param[in] name The name of the segment.
+     * @param[in] operations The operations on the type of the items.
+     * @param[in] options The options of the buffer. The ordering of the items is the one used to create the segment.
+     * @return The buffer, or null if the segment does not exist, it was not created for items of the size of 'operations' or
+     * 'options.overflowPolicy' drops or overwrites items.
+     */
+    static std::unique_ptr<InlineSharedMemoryBuffer> attach(const std::string& name, std::unique_ptr<IInlineItems> operations, const BufferOptions& options);
+
+protected:
+
+    void fillItems(size_t first, size_t count) override;
+
+    void emptyItems(size_t first, size_t count) override;
+
+    void resetItem(size_t index) override;
+
+private:
+
+    InlineSharedMemoryBuffer(std::unique_ptr<IInlineItems> operations, const BufferOptions& options);
+
+    /**
+     * @return The item of the slot 'index'.
+     */
+    void* getItem(size_t index) const;
+
+    /**
+     * Calls 'function' with the first item and the number of items of each contiguous range of the slots ['first', 'first' + 'count'),
+     * which are at most two.
+     */
+    template <class Function>
+    void forEachRange(size_t first, size_t count, Function function) const;
+
+    std::unique_ptr<IInlineItems> operations_;
+};
+
+#endif
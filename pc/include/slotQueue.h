@@ -0,0 +1,788 @@
+#ifndef PC_SLOT_QUEUE_H
+#define PC_SLOT_QUEUE_H
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
+#include <mutex>
+#include <functional>
+#include "IPCOptions.h"
+#include "IBufferEventSink.h"
+#include "BufferStatistics.h"
+#include "IActor.h"
+
+/**
+ * The state of each slot of a 'SlotQueue'. A slot is reserved by moving it to 'FILLING' or 'EMPTYING' while holding the mutex of the queue,
+ * and it is published by moving it to 'FULL' or 'EMPTY' once the item has been filled or emptied.
+ */
+enum class SlotState : uint8_t
+{
+    EMPTY,    //The item can be reserved by a producer.
+    FILLING,  //A producer is filling the item.
+    FULL,     //The item can be reserved by a consumer.
+    EMPTYING, //A consumer is emptying the item.
+    ABANDONED //The producer died while filling the item. The next consumer discards it without emptying it. Only used in shared memory.
+};
+
+/**
+ * The indices of a 'SlotQueue'. They are stored by the buffer, next to its slots, so that a shared memory buffer can keep them in its segment.
+ */
+struct SlotIndices
+{
+    size_t currentIndex; //The number of items reserved by producers and not yet by consumers. In a LIFO buffer, the index of the next item to be produced.
+    size_t head; //The index of the oldest produced item. It is always 0 in a LIFO buffer.
+    size_t notFullWaiters; //The number of producers waiting on the not full condition variable.
+    size_t notEmptyWaiters; //The number of consumers waiting on the not empty condition variable.
+};
+
+/**
+ * The algorithm of the buffers whose slots are reserved while holding a mutex, shared by 'SharedBuffer', within a process, and by
+ * 'SharedMemoryBuffer', across processes.
+ *
+ * Producers and consumers reserve consecutive slots under the mutex, fill or empty their items without holding it, and publish them under
+ * the mutex again, so several actors can work on different items at the same time. Producers wait on the not full condition variable while
+ * the buffer is full and consumers on the not empty one while it is empty, and each published item wakes up a single actor of the opposite role.
+ * The actors that do not block a thread, like the pooled actors and the coroutines, register a waiter instead, which is called as a waiting
+ * thread would be woken up.
+ * Items can be published out of order, and the actors woken up for an item that is not the next one go back to sleep, so an actor that
+ * leaves slots it could reserve behind wakes up one more actor of its own role.
+ * When the overflow policy drops or overwrites the oldest items, a producer that finds the buffer full moves the head forward and reserves
+ * the slot of the oldest item under the same lock, so consumers never see a half dropped item.
+ *
+ * The queue does not own its slots, its indices nor its synchronization, so they can live in the memory of a process or in a shared memory segment.
+ * 'Mutex' should be usable with 'std::unique_lock'. 'ConditionVariable' should have the methods
+ * 'bool wait(std::unique_lock<Mutex>&, const std::function<bool()>& ready, const std::function<bool()>& probe,
+ * const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups)', where 'probe' is the lock-free check of 'IWaitStrategy::wait',
+ * 'void notifyOne()', 'void notifyAll()' and 'bool parksThreads() const'. 'Slot' should have a member 'state' of type 'SlotState',
+ * and its other members identify the owner of a reserved slot.
+ */
+template <class Mutex, class ConditionVariable, class Slot>
+class SlotQueue
+{
+public:
+    using Lock = std::unique_lock<Mutex>;
+
+    /**
+     * Constructor. The queue cannot be used until 'attach' is called.
+     *
+     * @param[in] overflowPolicy What producers do when the buffer is full.
+     * @param[in/out] eventSink The sink of the events of the buffer.
+     */
+    SlotQueue(OverflowPolicy overflowPolicy, IBufferEventSink& eventSink);
+
+    /**
+     * Sets the storage of the queue.
+     *
+     * @param[in/out] mutex The mutex that protects 'slots' and 'indices'.
+     * @param[in/out] notFullCV The condition variable where producers wait while the buffer is full.
+     * @param[in/out] notEmptyCV The condition variable where consumers wait while the buffer is empty.
+     * @param[in/out] slots The 'size' slots of the buffer.
+     * @param[in/out] indices The indices of the buffer.
+     * @param[in] size The number of slots.
+     * @param[in] ordering The order of the items. It should be the one returned by 'getOrdering'.
+     * @param[in] owner The slot written to reserve a slot, apart from its state.
+     */
+    void attach(Mutex& mutex, ConditionVariable& notFullCV, ConditionVariable& notEmptyCV, Slot* slots, SlotIndices& indices, size_t size,
+                BufferOrdering ordering, const Slot& owner);
+
+    /**
+     * @param[in] ordering The ordering requested in the options of the buffer.
+     * @param[in] overflowPolicy The overflow policy of the buffer.
+     * @return The ordering of a queue with 'overflowPolicy'. A queue that drops or overwrites its oldest items is always FIFO, since
+     * the oldest item is only at the head in a FIFO buffer.
+     */
+    static BufferOrdering getOrdering(BufferOrdering ordering, OverflowPolicy overflowPolicy);
+
+    /**
+     * Fills up to 'count' items, waiting until 'deadline' at most while the buffer is full.
+     *
+     * @param[in] producer The producer, or null if the caller is not an actor.
+     * @param[in] count The maximum number of items to fill.
+     * @param[in] deadline The point in time when the call gives up.
+     * @param[in] fill Fills the items of the reserved slots, as 'fill(first, count)', without holding the mutex.
+     * @param[in] drop Empties the items dropped by 'OverflowPolicy::DROP_OLDEST', as 'drop(first, count)', without holding the mutex.
+     * @return The number of filled items.
+     */
+    template <class Fill, class Drop>
+    size_t produce(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline, Fill fill, Drop drop);
+
+    /**
+     * Fills up to 'count' items as 'produce' does, but returns 0 straight away if the buffer is full or stopped.
+     *
+     * @param[in] retried Whether the caller tries again with the items that do not fit, which are then not counted as rejected.
+     */
+    template <class Fill, class Drop>
+    size_t tryProduce(size_t count, Fill fill, Drop drop, bool retried);
+
+    /**
+     * Empties up to 'count' items, waiting until 'deadline' at most while the buffer is empty.
+     *
+     * @param[in] consumer The consumer, or null if the caller is not an actor.
+     * @param[in] count The maximum number of items to empty.
+     * @param[in] deadline The point in time when the call gives up.
+     * @param[in] empty Empties the items of the reserved slots, as 'empty(first, count)', without holding the mutex.
+     * @return The number of emptied items.
+     */
+    template <class Empty>
+    size_t consume(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline, Empty empty);
+
+    /**
+     * Empties up to 'count' items as 'consume' does, but returns 0 straight away if the buffer is empty or stopped.
+     */
+    template <class Empty>
+    size_t tryConsume(size_t count, Empty empty);
+
+    /**
+     * Registers 'waiter' to be called once, when the buffer may not be full (for a producer) or not empty (for a consumer).
+     * See 'ISharedBuffer::addWaiter'.
+     *
+     * @return false if the buffer is stopped or it is already ready for 'role', in which case 'waiter' is not registered.
+     */
+    bool addWaiter(ActorRole role, const std::function<void()>& waiter);
+
+    /**
+     * See 'IItemsBuffer::isReady'.
+     */
+    bool isReady(ActorRole role) const;
+
+    /**
+     * Raises the quit signal and wakes up all the waiting actors.
+     */
+    void stop();
+
+    /**
+     * Wakes up all the waiting actors, so they can check whether they are stopped.
+     */
+    void notify();
+
+    /**
+     * Wakes up all the waiting actors, for example after slots have been recovered.
+     *
+     * @note The mutex should be held by the caller.
+     */
+    void wakeAll();
+
+    /**
+     * Calls all the registered waiters, without waking up the waiting threads.
+     *
+     * @note The mutex should be held by the caller.
+     */
+    void callWaiters();
+
+    /**
+     * @return Whether the quit signal is not raised.
+     */
+    bool isRunning() const;
+
+    /**
+     * @return The number of items reserved by producers and not yet by consumers.
+     */
+    size_t getCurrentIndex() const;
+
+    /**
+     * @return The statistics of the actors that use this queue.
+     */
+    BufferStatistics getStatistics() const;
+
+    /**
+     * @return The index of the slot placed 'offset' positions after the slot 'first', wrapping around the end of the buffer.
+     */
+    size_t getSlot(size_t first, size_t offset) const;
+
+private:
+
+    /**
+     * @return Whether the overflow policy drops or overwrites the oldest items when the buffer is full.
+     */
+    bool dropsOldest() const;
+
+    /**
+     * @return The index of the slot that the next producer will reserve. In a LIFO buffer this is the current index.
+     * @note The mutex should be held by the caller.
+     */
+    size_t getProduceSlot() const;
+
+    /**
+     * @return The index of the slot that the next consumer will reserve. In a LIFO buffer this is the current index minus one, and in a FIFO buffer the head.
+     * @note The mutex should be held by the caller.
+     */
+    size_t getConsumeSlot() const;
+
+    /**
+     * @return Whether a producer can reserve the slot 'getProduceSlot()'.
+     * @note The mutex should be held by the caller.
+     */
+    bool canProduce() const;
+
+    /**
+     * @return Whether a producer can drop the oldest item to reserve its slot, because the buffer is full and the item is published.
+     * @note The mutex should be held by the caller.
+     */
+    bool canDropOldest() const;
+
+    /**
+     * @return Whether a consumer can reserve the slot 'getConsumeSlot()', or discard it when it is 'ABANDONED'.
+     * @note The mutex should be held by the caller.
+     */
+    bool canConsume() const;
+
+    /**
+     * Checks the overflow policy when the buffer is full and a producer cannot reserve 'getProduceSlot()', and counts the rejected items.
+     *
+     * @param[in] count The number of items that the producer wanted to fill and that do not fit in the buffer.
+     * @return Whether the producer should give up, because the overflow policy rejects the new items.
+     * @note The mutex should be held by the caller.
+     */
+    bool rejectItems(size_t count);
+
+    /**
+     * Reserves up to 'count' consecutive slots, fills their items without holding the mutex and publishes them.
+     *
+     * @param[in/out] lock The lock of the mutex, held by the caller. It is released when the call returns.
+     * @param[in] retried Whether the caller tries again with the items that do not fit, which are then not counted as rejected.
+     * @note 'canProduce()' or 'canDropOldest()' should be true.
+     */
+    template <class Fill, class Drop>
+    size_t reserveAndFill(Lock& lock, size_t count, Fill& fill, Drop& drop, bool retried);
+
+    /**
+     * Reserves up to 'count' consecutive slots, empties their items without holding the mutex and releases them.
+     * The 'ABANDONED' slots found first are discarded.
+     *
+     * @param[in/out] lock The lock of the mutex, held by the caller. It is released when the call returns.
+     * @note 'canConsume()' should be true.
+     */
+    template <class Empty>
+    size_t reserveAndEmpty(Lock& lock, size_t count, Empty& empty);
+
+    /**
+     * Discards the 'ABANDONED' slot 'getConsumeSlot()', as if it had been consumed.
+     *
+     * @note The mutex should be held by the caller.
+     */
+    void discardAbandonedSlot();
+
+    /**
+     * Waits on 'conditionVariable' until 'ready' returns true or until 'deadline'. The wakeups after which 'ready' is still false are counted
+     * in 'statistics_'. The threads that spin do it on 'changes_', without holding the mutex.
+     *
+     * @param[in/out] lock The lock of the mutex, held by the caller.
+     * @param[in/out] conditionVariable The condition variable to wait on.
+     * @param[in/out] waiters The number of threads waiting on 'conditionVariable'.
+     * @param[in] ready The condition to wait for.
+     * @param[in] deadline The point in time when the wait gives up.
+     * @return The last value returned by 'ready'.
+     */
+    bool wait(Lock& lock, ConditionVariable& conditionVariable, size_t& waiters, const std::function<bool()>& ready,
+              const std::chrono::steady_clock::time_point& deadline);
+
+    /**
+     * Wakes up one waiting thread for each published item, if 'conditionVariable' puts the waiting threads to sleep, and calls one registered
+     * waiter for each published item.
+     *
+     * @param[in/out] conditionVariable The condition variable to notify.
+     * @param[in] waiters The number of threads waiting on 'conditionVariable'.
+     * @param[in/out] registeredWaiters The registered waiters of the same role. The called ones are removed.
+     * @param[in] items The number of published items.
+     * @note The mutex should be held by the caller.
+     */
+    static void wakeWaiters(ConditionVariable& conditionVariable, size_t waiters, std::deque<std::function<void()>>& registeredWaiters, size_t items);
+
+    /**
+     * Records that the slots, the indices or the quit signal changed, so the threads spinning in 'wait' check their condition again.
+     *
+     * @note The mutex should be held by the caller.
+     */
+    void markChanged();
+
+    //The members below are only written by 'attach', so they can be cached by every core at the same time.
+    OverflowPolicy overflowPolicy_;
+    IBufferEventSink* eventSink_;
+    Mutex* mutex_;
+    ConditionVariable* notFullCV_;
+    ConditionVariable* notEmptyCV_;
+    Slot* slots_;
+    SlotIndices* indices_;
+    size_t size_;
+    BufferOrdering ordering_;
+    Slot owner_;
+
+    //The members below are written by every producer and consumer, so they start on their own cache line.
+    alignas(64) BufferStatistics statistics_; //Protected by 'mutex_'.
+    std::atomic<bool> quitSignal_; //Written under 'mutex_', but 'isRunning' reads it without locking, since actors check it before each operation.
+    std::atomic<size_t> changes_; //Increased under 'mutex_' each time the state changes, and read without it by the spinning threads.
+    std::deque<std::function<void()>> notFullRegisteredWaiters_; //The waiters registered by producers. Protected by 'mutex_'.
+    std::deque<std::function<void()>> notEmptyRegisteredWaiters_; //The waiters registered by consumers. Protected by 'mutex_'.
+};
+
+template <class Mutex, class ConditionVariable, class Slot>
+SlotQueue<Mutex, ConditionVariable, Slot>::SlotQueue(OverflowPolicy overflowPolicy, IBufferEventSink& eventSink)
+: overflowPolicy_(overflowPolicy)
+, eventSink_(&eventSink)
+, mutex_(nullptr)
+, notFullCV_(nullptr)
+, notEmptyCV_(nullptr)
+, slots_(nullptr)
+, indices_(nullptr)
+, size_(0)
+, ordering_(BufferOrdering::LIFO)
+, owner_()
+, quitSignal_(false)
+, changes_(0)
+{
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::attach(Mutex& mutex, ConditionVariable& notFullCV, ConditionVariable& notEmptyCV, Slot* slots,
+                                                       SlotIndices& indices, size_t size, BufferOrdering ordering, const Slot& owner)
+{
+    mutex_ = &mutex;
+    notFullCV_ = &notFullCV;
+    notEmptyCV_ = &notEmptyCV;
+    slots_ = slots;
+    indices_ = &indices;
+    size_ = size;
+    ordering_ = ordering;
+    owner_ = owner;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+BufferOrdering SlotQueue<Mutex, ConditionVariable, Slot>::getOrdering(BufferOrdering ordering, OverflowPolicy overflowPolicy)
+{
+    if (overflowPolicy == OverflowPolicy::DROP_OLDEST || overflowPolicy == OverflowPolicy::OVERWRITE)
+    {
+        return BufferOrdering::FIFO;
+    }
+
+    return ordering;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::dropsOldest() const
+{
+    return overflowPolicy_ == OverflowPolicy::DROP_OLDEST || overflowPolicy_ == OverflowPolicy::OVERWRITE;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::getProduceSlot() const
+{
+    return (indices_->head + indices_->currentIndex) % size_;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::getConsumeSlot() const
+{
+    if (ordering_ == BufferOrdering::FIFO)
+    {
+        return indices_->head;
+    }
+
+    return indices_->currentIndex - 1;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::getSlot(size_t first, size_t offset) const
+{
+    return (first + offset) % size_;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::canProduce() const
+{
+    return indices_->currentIndex < size_ && slots_[getProduceSlot()].state == SlotState::EMPTY;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::canDropOldest() const
+{
+    return dropsOldest() && indices_->currentIndex == size_ && slots_[indices_->head].state == SlotState::FULL;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::canConsume() const
+{
+    if (indices_->currentIndex == 0)
+    {
+        return false;
+    }
+
+    SlotState state = slots_[getConsumeSlot()].state;
+    return state == SlotState::FULL || state == SlotState::ABANDONED;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Fill, class Drop>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::produce(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline,
+                                                          Fill fill, Drop drop)
+{
+    Lock lock(*mutex_);
+    if (!canProduce() && !canDropOldest())
+    {
+        eventSink_->onBufferFull();
+        if (rejectItems(count))
+        {
+            return 0;
+        }
+
+        bool ready = wait(lock, *notFullCV_, indices_->notFullWaiters, [this, producer](){
+            return canProduce() || canDropOldest() || quitSignal_ || IBufferActor::isStopped(producer);
+        }, deadline);
+
+        if (!ready || quitSignal_ || IBufferActor::isStopped(producer))
+        {
+            return 0;
+        }
+    }
+
+    return reserveAndFill(lock, count, fill, drop, false);
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Fill, class Drop>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::tryProduce(size_t count, Fill fill, Drop drop, bool retried)
+{
+    Lock lock(*mutex_);
+    if (quitSignal_ || (!canProduce() && !canDropOldest()))
+    {
+        if (!quitSignal_ && !retried)
+        {
+            rejectItems(count);
+        }
+
+        return 0;
+    }
+
+    return reserveAndFill(lock, count, fill, drop, retried);
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::rejectItems(size_t count)
+{
+    if (overflowPolicy_ != OverflowPolicy::REJECT)
+    {
+        return false;
+    }
+
+    statistics_.droppedItems += count;
+    return true;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Fill, class Drop>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::reserveAndFill(Lock& lock, size_t count, Fill& fill, Drop& drop, bool retried)
+{
+    Slot reservation = owner_;
+    reservation.state = SlotState::FILLING;
+
+    size_t first = getProduceSlot();
+    size_t reserved = 0;
+    size_t dropped = 0;
+    for(; reserved < count; reserved++)
+    {
+        if (!canProduce())
+        {
+            if (!canDropOldest())
+            {
+                break;
+            }
+
+            //The slot of the oldest item becomes the produce slot, right after the slots reserved so far.
+            indices_->head = (indices_->head + 1) % size_;
+            indices_->currentIndex--;
+            dropped++;
+        }
+
+        slots_[getProduceSlot()] = reservation;
+        indices_->currentIndex++;
+    }
+    statistics_.droppedItems += dropped;
+    if (!retried)
+    {
+        rejectItems(count - reserved); //The items of a batch that did not fit.
+    }
+    markChanged();
+    if (canProduce() || canDropOldest())
+    {
+        wakeWaiters(*notFullCV_, indices_->notFullWaiters, notFullRegisteredWaiters_, 1);
+    }
+    lock.unlock();
+
+    if (overflowPolicy_ == OverflowPolicy::DROP_OLDEST && dropped > 0)
+    {
+        drop(getSlot(first, reserved - dropped), dropped);
+    }
+
+    fill(first, reserved);
+
+    lock.lock();
+    for(size_t i = 0; i < reserved; ++i)
+    {
+        slots_[getSlot(first, i)].state = SlotState::FULL;
+    }
+    markChanged();
+    wakeWaiters(*notEmptyCV_, indices_->notEmptyWaiters, notEmptyRegisteredWaiters_, reserved);
+    if (dropsOldest())
+    {
+        wakeWaiters(*notFullCV_, indices_->notFullWaiters, notFullRegisteredWaiters_, reserved); //Producers waiting for the oldest item to be published can drop it now.
+    }
+    lock.unlock();
+
+    eventSink_->onProduced(reserved);
+    return reserved;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Empty>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::consume(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline,
+                                                          Empty empty)
+{
+    Lock lock(*mutex_);
+    if (!canConsume())
+    {
+        eventSink_->onBufferEmpty();
+        bool ready = wait(lock, *notEmptyCV_, indices_->notEmptyWaiters, [this, consumer](){
+            return canConsume() || quitSignal_ || IBufferActor::isStopped(consumer);
+        }, deadline);
+
+        if (!ready || quitSignal_ || IBufferActor::isStopped(consumer))
+        {
+            return 0;
+        }
+    }
+
+    return reserveAndEmpty(lock, count, empty);
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Empty>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::tryConsume(size_t count, Empty empty)
+{
+    Lock lock(*mutex_);
+    if (quitSignal_ || !canConsume())
+    {
+        return 0;
+    }
+
+    return reserveAndEmpty(lock, count, empty);
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+template <class Empty>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::reserveAndEmpty(Lock& lock, size_t count, Empty& empty)
+{
+    Slot reservation = owner_;
+    reservation.state = SlotState::EMPTYING;
+
+    size_t first = indices_->head;
+    size_t reserved = 0;
+    while(reserved < count && canConsume())
+    {
+        if (slots_[getConsumeSlot()].state == SlotState::ABANDONED)
+        {
+            if (reserved > 0)
+            {
+                break; //The reserved slots should be consecutive.
+            }
+
+            discardAbandonedSlot();
+            first = indices_->head;
+            continue;
+        }
+
+        slots_[getConsumeSlot()] = reservation;
+        indices_->currentIndex--;
+        if (ordering_ == BufferOrdering::FIFO)
+        {
+            indices_->head = (indices_->head + 1) % size_;
+        }
+        reserved++;
+    }
+
+    if (ordering_ == BufferOrdering::LIFO)
+    {
+        first = indices_->currentIndex; //The reserved slots are the ones right after the new top of the stack.
+    }
+    markChanged();
+    if (canConsume())
+    {
+        wakeWaiters(*notEmptyCV_, indices_->notEmptyWaiters, notEmptyRegisteredWaiters_, 1);
+    }
+    lock.unlock();
+
+    empty(first, reserved);
+
+    lock.lock();
+    for(size_t i = 0; i < reserved; ++i)
+    {
+        slots_[getSlot(first, i)].state = SlotState::EMPTY;
+    }
+    markChanged();
+    wakeWaiters(*notFullCV_, indices_->notFullWaiters, notFullRegisteredWaiters_, reserved);
+    lock.unlock();
+
+    eventSink_->onConsumed(reserved);
+    return reserved;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::discardAbandonedSlot()
+{
+    slots_[getConsumeSlot()].state = SlotState::EMPTY;
+    indices_->currentIndex--;
+    if (ordering_ == BufferOrdering::FIFO)
+    {
+        indices_->head = (indices_->head + 1) % size_;
+    }
+    markChanged();
+    wakeWaiters(*notFullCV_, indices_->notFullWaiters, notFullRegisteredWaiters_, 1);
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::wait(Lock& lock, ConditionVariable& conditionVariable, size_t& waiters, const std::function<bool()>& ready,
+                                                     const std::chrono::steady_clock::time_point& deadline)
+{
+    waiters++;
+    size_t seenChanges = changes_.load(std::memory_order_relaxed);
+    bool isReady = conditionVariable.wait(lock, ready, [this, seenChanges]() mutable {
+        size_t changes = changes_.load(std::memory_order_relaxed);
+        bool changed = changes != seenChanges;
+        seenChanges = changes;
+        return changed;
+    }, deadline, &statistics_.spuriousWakeups);
+    waiters--;
+    return isReady;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::wakeWaiters(ConditionVariable& conditionVariable, size_t waiters,
+                                                            std::deque<std::function<void()>>& registeredWaiters, size_t items)
+{
+    for(size_t i = 0; i < items && !registeredWaiters.empty(); ++i)
+    {
+        registeredWaiters.front()();
+        registeredWaiters.pop_front();
+    }
+
+    if (waiters == 0 || !conditionVariable.parksThreads())
+    {
+        return;
+    }
+
+    if (items >= waiters)
+    {
+        conditionVariable.notifyAll();
+        return;
+    }
+
+    for(size_t i = 0; i < items; ++i)
+    {
+        conditionVariable.notifyOne();
+    }
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::stop()
+{
+    std::scoped_lock lock(*mutex_);
+    quitSignal_ = true;
+    wakeAll(); //If the signaling is performed without locking, Helgrind complains that the lock associated with 'quitSignal' is not held by any thread.
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::notify()
+{
+    std::scoped_lock lock(*mutex_);
+    wakeAll();
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::wakeAll()
+{
+    markChanged();
+    notFullCV_->notifyAll();
+    notEmptyCV_->notifyAll();
+    callWaiters();
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::callWaiters()
+{
+    for(auto* registeredWaiters: {&notFullRegisteredWaiters_, &notEmptyRegisteredWaiters_})
+    {
+        for(auto& waiter: *registeredWaiters)
+        {
+            waiter();
+        }
+        registeredWaiters->clear();
+    }
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::addWaiter(ActorRole role, const std::function<void()>& waiter)
+{
+    Lock lock(*mutex_);
+    if (quitSignal_)
+    {
+        return false;
+    }
+
+    if (role == ActorRole::PRODUCER)
+    {
+        if (canProduce() || canDropOldest())
+        {
+            return false;
+        }
+        notFullRegisteredWaiters_.push_back(waiter);
+    }
+    else
+    {
+        if (canConsume())
+        {
+            return false;
+        }
+        notEmptyRegisteredWaiters_.push_back(waiter);
+    }
+
+    return true;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::isReady(ActorRole role) const
+{
+    Lock lock(*mutex_);
+    if (quitSignal_)
+    {
+        return false;
+    }
+
+    return role == ActorRole::PRODUCER ? canProduce() || canDropOldest() : canConsume();
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+void SlotQueue<Mutex, ConditionVariable, Slot>::markChanged()
+{
+    changes_.store(changes_.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed); //Only written under the mutex.
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+bool SlotQueue<Mutex, ConditionVariable, Slot>::isRunning() const
+{
+    return !quitSignal_;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+size_t SlotQueue<Mutex, ConditionVariable, Slot>::getCurrentIndex() const
+{
+    std::scoped_lock lock(*mutex_);
+    return indices_->currentIndex;
+}
+
+template <class Mutex, class ConditionVariable, class Slot>
+BufferStatistics SlotQueue<Mutex, ConditionVariable, Slot>::getStatistics() const
+{
+    std::scoped_lock lock(*mutex_);
+    return statistics_;
+}
+
+#endif
@@ -0,0 +1,118 @@
+#ifndef PC_STAGE_WORKER_H
+#define PC_STAGE_WORKER_H
+
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "IActor.h"
+#include "IItemsBuffer.h"
+
+/**
+ * The state shared by the workers of a stage of a pipeline, which move items from the buffer 'input' to the buffer 'output'.
+ */
+struct PipelineStage
+{
+    using Transform = std::function<void(IBufferItem& input, IBufferItem& output)>; //Moves the content of an input item to an output item.
+
+    IItemsBuffer* input;
+    IItemsBuffer* output;
+    bool outputRejects; //Whether 'output' rejects the items that do not fit instead of waiting for room, that is, whether its overflow policy is 'REJECT'.
+    Transform transform;
+    std::atomic<size_t> droppedItems; //The input items emptied without being moved, because 'output' rejected them or it was stopped.
+    std::mutex mutex; //Serializes the moves of all the workers of the stage, the only producers of 'output', so the room that a worker finds in 'output' is not taken by another one.
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] _input The buffer where the workers will extract items from.
+     * @param[in/out] _output The buffer where the workers will insert items.
+     * @param[in] _outputRejects Whether the overflow policy of '_output' is 'REJECT'.
+     * @param[in] _transform Moves the content of each input item into an output item, emptying the former and filling the latter.
+     */
+    PipelineStage(IItemsBuffer* _input, IItemsBuffer* _output, bool _outputRejects, const Transform& _transform);
+
+    /**
+     * Moves up to 'count' items without waiting while 'input' has items and 'output' has room for them. An item is only consumed from 'input'
+     * once 'output' has room for it, so a worker never owns an item that it cannot move. If 'output' rejects the item or it is stopped, the item
+     * is emptied and counted in 'droppedItems'.
+     *
+     * @param[in] count The maximum number of items to move.
+     * @param[out] waitingRole 'ActorRole::PRODUCER' if it stopped because 'output' is full, 'ActorRole::CONSUMER' if 'input' is empty.
+     * @return The number of moved items.
+     * @note 'mutex' should be held by the caller.
+     */
+    size_t moveItems(size_t count, ActorRole& waitingRole);
+
+private:
+
+    /**
+     * Moves the content of 'item', an input item, into an item of 'output' that 'moveItems' found room for.
+     *
+     * @param[in/out] item The input item.
+     */
+    void move(IBufferItem& item);
+};
+
+/**
+ * An actor that moves items from a buffer of a pipeline to the next one on its own thread. It is the consumer of its input buffer and the producer of its output buffer.
+ */
+class StageWorker : public IBufferActor
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in/out] stage The stage of the worker. It should outlive the worker.
+     */
+    explicit StageWorker(PipelineStage& stage);
+
+    /**
+     * Raises the quit signal and wakes up this worker if it is waiting for its buffers.
+     */
+    void requestStop() override;
+
+private:
+
+    /**
+     * Wakes up a worker waiting for its buffers. The waiters registered in the buffers share it, so a waiter called after the worker is destroyed is harmless.
+     */
+    struct Wakeup
+    {
+        bool ready; //Whether the buffer that the worker waits for called its waiter.
+        std::mutex mutex; //Synchronizes accesses to 'ready'.
+        std::condition_variable readyCV;
+    };
+
+    /**
+     * Starts moving items from the input buffer of 'stage_' to its output buffer. The items are moved with 'PipelineStage::moveItems', as the
+     * pooled workers do, so the worker never owns an input item while it waits: while the input buffer is empty or the output buffer is full,
+     * it waits on its own thread for a waiter registered in that buffer.
+     *
+     * @param[in] options The options of the worker. Each time, the worker will move up to 'options.batchSize' items and then wait 'options.delay', or the delay set later by 'setDelay'.
+     */
+    void run(const ActorOptions& options) override;
+
+    /**
+     * Moves up to 'count' items, waiting until at least one of them can be moved.
+     *
+     * @param[in] count The maximum number of items to move.
+     * @return The number of moved items, 0 if the worker or a buffer was stopped.
+     */
+    size_t moveItems(size_t count);
+
+    /**
+     * Waits until the buffer of 'stage_' that 'role' interacts with is ready, or until the worker is stopped.
+     *
+     * @param[in] role 'ActorRole::PRODUCER' to wait for room in the output buffer, 'ActorRole::CONSUMER' to wait for items in the input buffer.
+     * @return Whether the worker and both buffers are still running.
+     */
+    bool waitForBuffer(ActorRole role);
+
+    PipelineStage& stage_;
+    std::shared_ptr<Wakeup> wakeup_;
+};
+
+#endif
@@ -0,0 +1,93 @@
+#ifndef PC_THREAD_CACHE_H
+#define PC_THREAD_CACHE_H
+
+#include <functional>
+#include <future>
+#include <list>
+#include <memory>
+#include <vector>
+#include <thread>
+#include <mutex>
+#include <condition_variable>
+
+/**
+ * Runs each task on a thread of its own, like 'std::thread' does, but the threads that finish a task are parked to run the next tasks
+ * instead of exiting. Actors that are added after others are removed reuse warm threads, with their stacks and thread local storage.
+ * The cache is not fork-safe: a child process inherits its workers without their threads, and possibly its mutex locked, so the child
+ * should not use a cache created before the fork.
+ */
+class ThreadCache
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] maxParkedThreads The maximum number of parked threads. The threads that finish a task when there are already as many parked ones exit.
+     */
+    explicit ThreadCache(size_t maxParkedThreads);
+
+    /**
+     * Destructor. It joins all the threads, so the tasks should be finished.
+     */
+    ~ThreadCache();
+
+    ThreadCache(const ThreadCache&) = delete;
+
+    ThreadCache& operator=(const ThreadCache&) = delete;
+
+    /**
+     * Runs 'task' on a parked thread, or on a new thread if none is parked.
+     *
+     * @param[in] task The task.
+     * @return A future that becomes ready once the task is finished.
+     */
+    std::future<void> run(const std::function<void()>& task);
+
+    /**
+     * @return The number of threads waiting for a task.
+     */
+    size_t getNumberOfParkedThreads();
+
+    /**
+     * @return The cache used by the actors that run on their own threads.
+     */
+    static ThreadCache& getDefault();
+
+private:
+    static constexpr size_t DEFAULT_MAX_PARKED_THREADS = 64;
+
+    /**
+     * A thread of the cache and the task it has to run next.
+     */
+    struct Worker
+    {
+        std::thread thread;
+        std::function<void()> task;
+        std::promise<void> finished;
+        bool hasTask; //Whether 'task' is pending.
+        std::condition_variable taskCV; //The thread waits on it while it is parked.
+        std::list<std::unique_ptr<Worker>>::iterator position; //The position of the worker in 'workers_'.
+    };
+
+    /**
+     * The loop of the thread of 'worker'. It runs the tasks handed to 'worker' until the thread exits.
+     *
+     * @param[in/out] worker The worker of the thread.
+     */
+    void runWorker(Worker* worker);
+
+    /**
+     * Joins the threads that have exited, and destroys their workers.
+     */
+    void joinExitedThreads();
+
+    size_t maxParkedThreads_;
+    std::list<std::unique_ptr<Worker>> workers_; //The workers whose threads have not exited.
+    std::vector<Worker*> parked_; //The workers waiting for a task.
+    std::vector<std::unique_ptr<Worker>> exited_; //The workers whose threads have exited and must be joined.
+    bool quitSignal_;
+    std::mutex mutex_; //Synchronizes accesses to all the members.
+};
+
+#endif
@@ -0,0 +1,107 @@
+#ifndef PC_WAIT_STRATEGY_H
+#define PC_WAIT_STRATEGY_H
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <condition_variable>
+#include <functional>
+#include "IPCOptions.h"
+
+/**
+ * Class that decides how a thread waits for a condition: by sleeping on a condition variable, by spinning, or by a mix of both.
+ *
+ * It is used by the shared buffers while they are full or empty, and by the actors while they rest between two interactions with the buffer.
+ */
+class IWaitStrategy
+{
+public:
+
+    /**
+     * Waits until 'ready' returns true or until 'deadline' is reached.
+     *
+     * @param[in/out] lock The lock of the mutex that protects the state checked by 'ready'. It is held when 'ready' is called and when this
+     * method returns, but it may be released while waiting.
+     * @param[in/out] conditionVariable The condition variable notified when the state checked by 'ready' changes.
+     * @param[in] ready The condition to wait for.
+     * @param[in] probe A check that does not need 'lock', and returns true when 'ready' may have become true. The strategies that spin call it
+     * without holding 'lock', which is only taken to check 'ready' once 'probe' returns true, or to sleep. A condition that only reads atomic
+     * state can be both 'ready' and 'probe'.
+     * @param[in] deadline The point in time when the wait gives up. 'std::chrono::steady_clock::time_point::max()' waits without a limit.
+     * @param[out] spuriousWakeups If not null, it is increased each time the thread wakes up from 'conditionVariable' and 'ready' is still false.
+     * @return The last value returned by 'ready'.
+     */
+    virtual bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+                      const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups) = 0;
+
+    /**
+     * @return Whether this strategy puts threads to sleep on the condition variable, in which case the threads that change the
+     * state should notify it.
+     */
+    virtual bool parksThreads() const = 0;
+
+    /**
+     * Creates a wait strategy.
+     *
+     * @param[in] type The type of the wait strategy.
+     * @return The new wait strategy.
+     */
+    static std::unique_ptr<IWaitStrategy> create(WaitStrategy type);
+
+    virtual ~IWaitStrategy(){}
+};
+
+/**
+ * Waits on the condition variable until it is notified. Idle threads do not use any CPU.
+ */
+class BlockingWaitStrategy : public IWaitStrategy
+{
+public:
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+              const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups) override;
+
+    bool parksThreads() const override;
+};
+
+/**
+ * Spins a bounded number of times, executing a pause instruction between two probes of the condition, and then waits on the condition variable.
+ * Short waits are served without a context switch, and long waits do not burn CPU.
+ */
+class SpinThenParkWaitStrategy : public IWaitStrategy
+{
+public:
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+              const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups) override;
+
+    bool parksThreads() const override;
+
+private:
+    BlockingWaitStrategy blockingWaitStrategy_;
+};
+
+/**
+ * Yields the processor between two probes of the condition.
+ */
+class YieldingWaitStrategy : public IWaitStrategy
+{
+public:
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+              const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups) override;
+
+    bool parksThreads() const override;
+};
+
+/**
+ * Probes the condition continuously, executing only a pause instruction between two probes. It gives the lowest latency, but each
+ * waiting thread keeps a core busy.
+ */
+class BusyPollWaitStrategy : public IWaitStrategy
+{
+public:
+    bool wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+              const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups) override;
+
+    bool parksThreads() const override;
+};
+
+#endif
@@ -0,0 +1,78 @@
+#include "BufferAwaitable.h"
+#include "ISharedBuffer.h"
+#include "awaitContext.h"
+#include "executor.h"
+
+BufferAwaitable::BufferAwaitable(ISharedBuffer* sharedBuffer, ActorRole role, size_t count, const std::shared_ptr<AwaitContext>& context)
+: sharedBuffer_(sharedBuffer)
+, role_(role)
+, count_(count)
+, context_(context)
+, result_(0)
+{}
+
+bool BufferAwaitable::await_ready()
+{
+    return tryOperation();
+}
+
+void BufferAwaitable::await_suspend(std::coroutine_handle<> handle)
+{
+    waitForBuffer(handle);
+}
+
+size_t BufferAwaitable::await_resume() const
+{
+    return result_;
+}
+
+bool BufferAwaitable::tryOperation()
+{
+    if (!context_->enter())
+    {
+        result_ = 0;
+        return true;
+    }
+
+    bool complete = true;
+    if (sharedBuffer_->isRunning())
+    {
+        result_ = role_ == ActorRole::PRODUCER ? sharedBuffer_->retryProduceBatch(count_) : sharedBuffer_->tryConsumeBatch(count_);
+        complete = result_ > 0;
+    }
+
+    context_->leave();
+    return complete;
+}
+
+void BufferAwaitable::waitForBuffer(std::coroutine_handle<> handle)
+{
+    bool registered = false;
+    if (context_->enter())
+    {
+        //The buffer calls the waiter while it may be locked, so the waiter only schedules the try.
+        registered = sharedBuffer_->isRunning() && sharedBuffer_->addWaiter(role_, [this, handle](){
+            retry(handle);
+        });
+        context_->leave();
+    }
+
+    if (!registered)
+    {
+        retry(handle);
+    }
+}
+
+void BufferAwaitable::retry(std::coroutine_handle<> handle)
+{
+    //This object lives in the frame of the suspended coroutine, so it is valid until the coroutine is resumed.
+    Executor::getDefault().schedule([this, handle](){
+        if (tryOperation())
+        {
+            handle.resume();
+            return;
+        }
+
+        waitForBuffer(handle);
+    }, std::chrono::steady_clock::now());
+}
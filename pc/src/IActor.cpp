@@ -1,14 +1,95 @@
+#include <algorithm>
+#include <sys/prctl.h>
 #include "IActor.h"
-#include "sharedBuffer.h"
+#include "ISharedBuffer.h"
+#include "RateLimiter.h"
+#include "waitStrategy.h"
+#include "threadCache.h"
+#include "actorAllocator.h"
 
-IBufferActor::IBufferActor(SharedBuffer* buffer)
+ActorCounters::ActorCounters()
+: delay(0)
+, items(0)
+, operations(0)
+{}
+
+void ActorCounters::record(size_t count)
+{
+    items.fetch_add(count, std::memory_order_relaxed);
+    operations.fetch_add(1, std::memory_order_relaxed);
+}
+
+std::chrono::nanoseconds ActorCounters::getDelay() const
+{
+    return std::chrono::nanoseconds(delay.load(std::memory_order_relaxed));
+}
+
+ActorStatistics ActorCounters::getStatistics() const
+{
+    ActorStatistics statistics;
+    statistics.items = items.load(std::memory_order_relaxed);
+    statistics.operations = operations.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+constexpr std::chrono::milliseconds ActorPacer::MAX_LAG;
+
+ActorPacer::ActorPacer(ActorPacing pacing)
+: pacing_(pacing)
+, begin_()
+, steps_(1)
+, deadline_()
+, started_(false)
+{}
+
+void ActorPacer::beginRest(size_t count, const std::chrono::steady_clock::time_point& now)
+{
+    if (pacing_ == ActorPacing::AFTER_OPERATION || !started_ || deadline_ + MAX_LAG < now)
+    {
+        begin_ = now;
+    }
+    else
+    {
+        begin_ = deadline_;
+    }
+
+    //A fixed-rate actor that did not move any item still waits one delay, so it does not retry in a loop.
+    steps_ = pacing_ == ActorPacing::FIXED_RATE ? std::max<size_t>(count, 1) : 1;
+    started_ = true;
+}
+
+std::chrono::steady_clock::time_point ActorPacer::getDeadline(const std::chrono::nanoseconds& delay)
+{
+    deadline_ = begin_ + delay * steps_;
+    return deadline_;
+}
+
+IBufferActor::IBufferActor(ISharedBuffer* buffer)
 : sharedBuffer_(buffer)
+, pacer_(ActorPacing::AFTER_OPERATION)
+, rateLimiter_(nullptr)
 , quitSignal_(false)
 {}
 
-void IBufferActor::start(const std::chrono::milliseconds& delay)
+void IBufferActor::start(const ActorOptions& options)
 {
-    thread_ = std::thread(&IBufferActor::run, this, delay);
+    counters_.delay = options.delay.count();
+    pacer_ = ActorPacer(options.pacing);
+    rateLimiter_ = options.rateLimiter;
+    finished_ = ThreadCache::getDefault().run([this, options](){
+        if (options.pacing == ActorPacing::FIXED_RATE)
+        {
+            //The default timer slack of Linux delays each wake-up up to 50us, which is more than the interval of a fast fixed-rate actor.
+            int timerSlack = prctl(PR_GET_TIMERSLACK);
+            prctl(PR_SET_TIMERSLACK, FIXED_RATE_TIMER_SLACK);
+            run(options);
+            prctl(PR_SET_TIMERSLACK, timerSlack);
+        }
+        else
+        {
+            run(options);
+        }
+    });
 }
 
 bool IBufferActor::isRunning() const
@@ -16,24 +97,103 @@ bool IBufferActor::isRunning() const
     return !quitSignal_;
 }
 
+void* IActor::operator new(size_t size)
+{
+    return ActorAllocator::getDefault().allocate(size);
+}
+
+void IActor::operator delete(void* pointer, size_t size)
+{
+    ActorAllocator::getDefault().deallocate(pointer, size);
+}
+
+void IActor::stop()
+{
+    requestStop();
+    join();
+}
+
 void IBufferActor::stop()
 {
-    mutex_.lock();
-    quitSignal_ = true;
-    sharedBuffer_->notify();
+    requestStop();
+    notifyBuffers();
+    join();
+}
+
+void IBufferActor::requestStop()
+{
+    {
+        std::scoped_lock lock(mutex_);
+        quitSignal_ = true;
+    }
+
+    //The actor is notified after releasing 'mutex_', so it does not block on it right after waking up.
+    stopCV_.notify_all();
+}
+
+void IBufferActor::join()
+{
+    finished_.wait();
+}
+
+void IBufferActor::setDelay(const std::chrono::nanoseconds& delay)
+{
+    std::scoped_lock lock(mutex_);
+    counters_.delay = delay.count();
     stopCV_.notify_all();
-    mutex_.unlock();
+}
+
+ActorStatistics IBufferActor::getStatistics() const
+{
+    return counters_.getStatistics();
+}
+
+bool IBufferActor::isStopped(const IBufferActor* actor)
+{
+    return actor != nullptr && !actor->isRunning();
+}
+
+std::chrono::steady_clock::time_point IBufferActor::getDeadline(const std::chrono::nanoseconds& timeout)
+{
+    if (timeout == std::chrono::nanoseconds::max())
+    {
+        return std::chrono::steady_clock::time_point::max();
+    }
+
+    return std::chrono::steady_clock::now() + timeout;
+}
 
-    thread_.join();
+void IBufferActor::notifyBuffers()
+{
+    sharedBuffer_->notify();
 }
 
-bool IBufferActor::rest(const std::chrono::milliseconds& delay)
+bool IBufferActor::rest(size_t count)
 {
+    if (counters_.getDelay() == std::chrono::nanoseconds::zero() && rateLimiter_ == nullptr)
+    {
+        return !quitSignal_;
+    }
+
+    std::chrono::steady_clock::time_point allowed = rateLimiter_ != nullptr ? rateLimiter_->acquire(count) : std::chrono::steady_clock::time_point();
     std::unique_lock<std::mutex> lock(mutex_);
-    auto quitPredicate = [this]()
+    pacer_.beginRest(count, std::chrono::steady_clock::now());
+    std::chrono::nanoseconds delay = counters_.getDelay();
+    auto wakeUpPredicate = [this, &delay]()
     {
-        return quitSignal_;
+        return quitSignal_ || counters_.getDelay() != delay;
     };
 
-    return !stopCV_.wait_for(lock, delay, quitPredicate);
+    //The deadline is computed again each time 'setDelay' wakes up this actor.
+    while(sharedBuffer_->getWaitStrategy().wait(lock, stopCV_, wakeUpPredicate, wakeUpPredicate, std::max(pacer_.getDeadline(delay), allowed), nullptr))
+    {
+        if (quitSignal_)
+        {
+            return false;
+        }
+
+        delay = counters_.getDelay();
+    }
+
+    return true;
 }
@@ -1,48 +1,122 @@
 #include "IPC.h"
-#include "manager.h"
 
-void IPC::start(const ItemsBuffer& buffer)
+ProducerConsumer& IPC::getInstance()
 {
-    ProducerConsumerManager::start(buffer);
+    static ProducerConsumer instance;
+    return instance;
 }
 
-void IPC::addProducer(const std::chrono::milliseconds& delay)
+void IPC::start(const ItemsBuffer& buffer, const BufferOptions& options)
 {
-    ProducerConsumerManager::addProducer(delay);
+    getInstance().start(buffer, options);
 }
 
-void IPC::addConsumer(const std::chrono::milliseconds& delay)
+IPC::ActorHandle IPC::addProducer(const std::chrono::nanoseconds& delay)
 {
-    ProducerConsumerManager::addConsumer(delay);
+    return getInstance().addProducer(ActorOptions(delay));
 }
 
-void IPC::removeConsumer()
+IPC::ActorHandle IPC::addProducer(const ActorOptions& options)
 {
-    ProducerConsumerManager::removeConsumer();
+    return getInstance().addProducer(options);
 }
 
-void IPC::removeProducer()
+IPC::ActorHandle IPC::addConsumer(const std::chrono::nanoseconds& delay)
 {
-    ProducerConsumerManager::removeProducer();
+    return getInstance().addConsumer(ActorOptions(delay));
+}
+
+IPC::ActorHandle IPC::addConsumer(const ActorOptions& options)
+{
+    return getInstance().addConsumer(options);
+}
+
+std::future<void> IPC::removeConsumer()
+{
+    return getInstance().removeConsumer();
+}
+
+std::future<void> IPC::removeProducer()
+{
+    return getInstance().removeProducer();
+}
+
+std::future<void> IPC::remove(ActorHandle handle)
+{
+    return getInstance().remove(handle);
+}
+
+bool IPC::setDelay(ActorHandle handle, const std::chrono::nanoseconds& delay)
+{
+    return getInstance().setDelay(handle, delay);
 }
 
 void IPC::removeConsumers()
 {
-    ProducerConsumerManager::removeConsumers();
+    getInstance().removeConsumers();
 }
 
 void IPC::removeProducers()
 {
-    ProducerConsumerManager::removeProducers();
+    getInstance().removeProducers();
 }
 
 void IPC::stop()
 {
-    ProducerConsumerManager::stop();
+    getInstance().stop();
+}
+
+BufferAwaitable IPC::produce(size_t count)
+{
+    return getInstance().produce(count);
+}
+
+BufferAwaitable IPC::consume(size_t count)
+{
+    return getInstance().consume(count);
+}
+
+size_t IPC::tryProduce(size_t count)
+{
+    return getInstance().tryProduce(count);
+}
+
+size_t IPC::tryConsume(size_t count)
+{
+    return getInstance().tryConsume(count);
+}
+
+size_t IPC::produceUntil(const std::chrono::steady_clock::time_point& deadline, size_t count)
+{
+    return getInstance().produceUntil(deadline, count);
+}
+
+size_t IPC::consumeUntil(const std::chrono::steady_clock::time_point& deadline, size_t count)
+{
+    return getInstance().consumeUntil(deadline, count);
+}
+
+size_t IPC::produceFor(const std::chrono::nanoseconds& timeout, size_t count)
+{
+    return getInstance().produceFor(timeout, count);
+}
+
+size_t IPC::consumeFor(const std::chrono::nanoseconds& timeout, size_t count)
+{
+    return getInstance().consumeFor(timeout, count);
 }
 
 size_t IPC::getCurrentIndex() 
 {
-    return ProducerConsumerManager::getCurrentIndex();
+    return getInstance().getCurrentIndex();
 }
 
+BufferStatistics IPC::getStatistics()
+{
+    return getInstance().getStatistics();
+}
+
+std::optional<ActorStatistics> IPC::getStatistics(ActorHandle handle)
+{
+    return getInstance().getStatistics(handle);
+}
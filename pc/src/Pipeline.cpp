@@ -0,0 +1,155 @@
+#include "Pipeline.h"
+#include "manager.h"
+#include "stageWorker.h"
+#include "pooledStageWorker.h"
+#include "executor.h"
+
+Pipeline::Pipeline()
+{
+}
+
+Pipeline::~Pipeline()
+{
+    stop();
+}
+
+void Pipeline::start(const std::vector<ItemsBuffer>& buffers, const std::vector<Transform>& transforms, const BufferOptions& options)
+{
+    for(const auto& buffer: buffers)
+    {
+        IItemsBuffer* itemsBuffer = ProducerConsumerManager::createBuffer(buffer, options);
+        managers_.emplace_back(new ProducerConsumerManager);
+        managers_.back()->start(itemsBuffer);
+        buffers_.push_back(itemsBuffer);
+    }
+
+    for(size_t stage = 0; stage < getNumberOfStages(); ++stage)
+    {
+        Transform transform = stage < transforms.size() ? transforms[stage] : Transform();
+        if (!transform)
+        {
+            transform = [](IBufferItem& input, IBufferItem& output){
+                input.empty();
+                output.fill();
+            };
+        }
+
+        stages_.emplace_back(new PipelineStage(buffers_[stage], buffers_[stage + 1], options.overflowPolicy == OverflowPolicy::REJECT, transform));
+    }
+
+    workers_.resize(getNumberOfStages());
+}
+
+size_t Pipeline::getNumberOfStages() const
+{
+    return buffers_.empty() ? 0 : buffers_.size() - 1;
+}
+
+void Pipeline::addProducer(const ActorOptions& options)
+{
+    managers_.front()->addProducer(options);
+}
+
+void Pipeline::addConsumer(const ActorOptions& options)
+{
+    managers_.back()->addConsumer(options);
+}
+
+void Pipeline::addWorker(size_t stage, const ActorOptions& options)
+{
+    std::scoped_lock lock(mutexWorkers_);
+    IItemsBuffer* input = buffers_[stage];
+    IItemsBuffer* output = buffers_[stage + 1];
+    if (!input->isRunning() || !output->isRunning())
+    {
+        return;
+    }
+
+    IActor* worker = nullptr;
+    if (options.execution == ActorExecution::DEDICATED_THREAD)
+    {
+        worker = new StageWorker(*stages_[stage]);
+    }
+    else
+    {
+        worker = new PooledStageWorker(*stages_[stage], Executor::getDefault());
+    }
+
+    input->setNumberOfConsumers(workers_[stage].size() + 1);
+    output->setNumberOfProducers(workers_[stage].size() + 1);
+    worker->start(options);
+    workers_[stage].push_back(worker);
+}
+
+void Pipeline::removeProducers()
+{
+    managers_.front()->removeProducers();
+}
+
+void Pipeline::removeConsumers()
+{
+    managers_.back()->removeConsumers();
+}
+
+void Pipeline::removeWorkers(size_t stage)
+{
+    std::scoped_lock lock(mutexWorkers_);
+    destroyWorkers(stage);
+}
+
+void Pipeline::destroyWorkers(size_t stage)
+{
+    for(auto worker: workers_[stage])
+    {
+        worker->requestStop();
+    }
+
+    buffers_[stage]->notify();
+    buffers_[stage + 1]->notify();
+    for(auto worker: workers_[stage])
+    {
+        worker->join();
+        delete worker;
+    }
+
+    workers_[stage].clear();
+    buffers_[stage]->setNumberOfConsumers(0);
+    buffers_[stage + 1]->setNumberOfProducers(0);
+}
+
+void Pipeline::stop()
+{
+    if (managers_.empty())
+    {
+        return;
+    }
+
+    removeProducers();
+    {
+        std::scoped_lock lock(mutexWorkers_);
+        for(size_t stage = 0; stage < workers_.size(); ++stage)
+        {
+            destroyWorkers(stage);
+        }
+    }
+
+    for(auto& manager: managers_)
+    {
+        manager->stop();
+    }
+
+    managers_.clear();
+    buffers_.clear();
+    stages_.clear();
+    workers_.clear();
+}
+
+size_t Pipeline::getCurrentIndex(size_t buffer) const
+{
+    return buffers_[buffer]->getCurrentIndex();
+}
+
+size_t Pipeline::getDroppedItems(size_t stage) const
+{
+    return stages_[stage]->droppedItems.load(std::memory_order_relaxed);
+}
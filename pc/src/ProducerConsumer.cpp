@@ -0,0 +1,162 @@
+#include "ProducerConsumer.h"
+#include "manager.h"
+#include "inlineSharedBuffer.h"
+#include "sharedMemoryBuffer.h"
+
+ProducerConsumer::ProducerConsumer()
+: manager_(new ProducerConsumerManager)
+{
+}
+
+ProducerConsumer::~ProducerConsumer()
+{
+}
+
+void ProducerConsumer::start(const ItemsBuffer& buffer, const BufferOptions& options)
+{
+    manager_->start(buffer, options);
+}
+
+void ProducerConsumer::start(ISharedBuffer* sharedBuffer)
+{
+    manager_->start(sharedBuffer);
+}
+
+void ProducerConsumer::startInline(void* items, size_t size, std::unique_ptr<IInlineItems> operations, const BufferOptions& options)
+{
+    start(new InlineSharedBuffer(items, size, std::move(operations), options));
+}
+
+bool ProducerConsumer::startShared(const std::string& name, size_t size, std::unique_ptr<IInlineItems> operations, const BufferOptions& options)
+{
+    auto sharedBuffer = InlineSharedMemoryBuffer::create(name, size, std::move(operations), options);
+    if (!sharedBuffer)
+    {
+        return false;
+    }
+
+    start(sharedBuffer.release());
+    return true;
+}
+
+bool ProducerConsumer::attachShared(const std::string& name, std::unique_ptr<IInlineItems> operations, const BufferOptions& options)
+{
+    auto sharedBuffer = InlineSharedMemoryBuffer::attach(name, std::move(operations), options);
+    if (!sharedBuffer)
+    {
+        return false;
+    }
+
+    start(sharedBuffer.release());
+    return true;
+}
+
+ProducerConsumer::ActorHandle ProducerConsumer::addProducer(const std::chrono::nanoseconds& delay)
+{
+    return manager_->addProducer(ActorOptions(delay));
+}
+
+ProducerConsumer::ActorHandle ProducerConsumer::addProducer(const ActorOptions& options)
+{
+    return manager_->addProducer(options);
+}
+
+ProducerConsumer::ActorHandle ProducerConsumer::addConsumer(const std::chrono::nanoseconds& delay)
+{
+    return manager_->addConsumer(ActorOptions(delay));
+}
+
+ProducerConsumer::ActorHandle ProducerConsumer::addConsumer(const ActorOptions& options)
+{
+    return manager_->addConsumer(options);
+}
+
+std::future<void> ProducerConsumer::removeConsumer()
+{
+    return manager_->removeConsumer();
+}
+
+std::future<void> ProducerConsumer::removeProducer()
+{
+    return manager_->removeProducer();
+}
+
+std::future<void> ProducerConsumer::remove(ActorHandle handle)
+{
+    return manager_->remove(handle);
+}
+
+bool ProducerConsumer::setDelay(ActorHandle handle, const std::chrono::nanoseconds& delay)
+{
+    return manager_->setDelay(handle, delay);
+}
+
+void ProducerConsumer::removeConsumers()
+{
+    manager_->removeConsumers();
+}
+
+void ProducerConsumer::removeProducers()
+{
+    manager_->removeProducers();
+}
+
+void ProducerConsumer::stop()
+{
+    manager_->stop();
+}
+
+BufferAwaitable ProducerConsumer::produce(size_t count)
+{
+    return manager_->produce(count);
+}
+
+BufferAwaitable ProducerConsumer::consume(size_t count)
+{
+    return manager_->consume(count);
+}
+
+size_t ProducerConsumer::tryProduce(size_t count)
+{
+    return manager_->tryProduce(count);
+}
+
+size_t ProducerConsumer::tryConsume(size_t count)
+{
+    return manager_->tryConsume(count);
+}
+
+size_t ProducerConsumer::produceUntil(const std::chrono::steady_clock::time_point& deadline, size_t count)
+{
+    return manager_->produceUntil(count, deadline);
+}
+
+size_t ProducerConsumer::consumeUntil(const std::chrono::steady_clock::time_point& deadline, size_t count)
+{
+    return manager_->consumeUntil(count, deadline);
+}
+
+size_t ProducerConsumer::produceFor(const std::chrono::nanoseconds& timeout, size_t count)
+{
+    return produceUntil(std::chrono::steady_clock::now() + timeout, count);
+}
+
+size_t ProducerConsumer::consumeFor(const std::chrono::nanoseconds& timeout, size_t count)
+{
+    return consumeUntil(std::chrono::steady_clock::now() + timeout, count);
+}
+
+size_t ProducerConsumer::getCurrentIndex() 
+{
+    return manager_->getCurrentIndex();
+}
+
+BufferStatistics ProducerConsumer::getStatistics()
+{
+    return manager_->getStatistics();
+}
+
+std::optional<ActorStatistics> ProducerConsumer::getStatistics(ActorHandle handle)
+{
+    return manager_->getStatistics(handle);
+}
@@ -0,0 +1,31 @@
+#include <algorithm>
+#include <cmath>
+#include "RateLimiter.h"
+
+RateLimiter::RateLimiter(double itemsPerSecond, size_t burst)
+: interval_(1e9 / itemsPerSecond)
+, tolerance_(std::llround(interval_ * burst))
+, nextTime_(0)
+{}
+
+std::chrono::steady_clock::time_point RateLimiter::acquire(size_t count)
+{
+    int64_t now = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    int64_t cost = std::llround(interval_ * count);
+    int64_t nextTime = nextTime_.load(std::memory_order_relaxed);
+    int64_t newNextTime;
+
+    //A bucket that has been idle is full, but it does not keep more than 'burst' tokens.
+    do
+    {
+        newNextTime = std::max(nextTime, now) + cost;
+    }
+    while(!nextTime_.compare_exchange_weak(nextTime, newNextTime, std::memory_order_relaxed));
+
+    return std::chrono::steady_clock::time_point(std::chrono::nanoseconds(newNextTime - tolerance_));
+}
+
+double RateLimiter::getRate() const
+{
+    return 1e9 / interval_;
+}
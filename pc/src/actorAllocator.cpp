@@ -0,0 +1,68 @@
+#include <new>
+#include "actorAllocator.h"
+
+constexpr size_t ActorAllocator::DEFAULT_MAX_FREE_BLOCKS;
+
+ActorAllocator::ActorAllocator(size_t maxFreeBlocks)
+: maxFreeBlocks_(maxFreeBlocks)
+{}
+
+ActorAllocator::~ActorAllocator()
+{
+    for(auto& blocks: freeBlocks_)
+    {
+        for(auto block: blocks.second)
+        {
+            ::operator delete(block);
+        }
+    }
+}
+
+void* ActorAllocator::allocate(size_t size)
+{
+    {
+        std::scoped_lock lock(mutex_);
+        std::vector<void*>& blocks = freeBlocks_[size];
+        if (!blocks.empty())
+        {
+            void* block = blocks.back();
+            blocks.pop_back();
+            return block;
+        }
+    }
+
+    return ::operator new(size);
+}
+
+void ActorAllocator::deallocate(void* pointer, size_t size)
+{
+    {
+        std::scoped_lock lock(mutex_);
+        std::vector<void*>& blocks = freeBlocks_[size];
+        if (blocks.size() < maxFreeBlocks_)
+        {
+            blocks.push_back(pointer);
+            return;
+        }
+    }
+
+    ::operator delete(pointer);
+}
+
+size_t ActorAllocator::getNumberOfFreeBlocks()
+{
+    std::scoped_lock lock(mutex_);
+    size_t numberOfFreeBlocks = 0;
+    for(auto& blocks: freeBlocks_)
+    {
+        numberOfFreeBlocks += blocks.second.size();
+    }
+
+    return numberOfFreeBlocks;
+}
+
+ActorAllocator& ActorAllocator::getDefault()
+{
+    static ActorAllocator allocator(DEFAULT_MAX_FREE_BLOCKS);
+    return allocator;
+}
@@ -0,0 +1,54 @@
+#include "awaitContext.h"
+
+AwaitContext::AwaitContext()
+: accesses_(0)
+, cancelled_(false)
+{}
+
+bool AwaitContext::enter()
+{
+    //The access is counted before checking the flag, and 'requestCancel' raises the flag before 'waitForAccesses' reads the counter, so
+    //either this call sees the context cancelled or 'waitForAccesses' waits for this access.
+    accesses_.fetch_add(1);
+    if (cancelled_.load())
+    {
+        leave();
+        return false;
+    }
+
+    return true;
+}
+
+void AwaitContext::leave()
+{
+    if (accesses_.fetch_sub(1) == 1 && cancelled_.load())
+    {
+        //Taking the mutex ensures that 'waitForAccesses' is either still to check the counter, or already waiting on 'accessesCV_'.
+        std::scoped_lock lock(mutex_);
+        accessesCV_.notify_all();
+    }
+}
+
+void AwaitContext::cancel()
+{
+    requestCancel();
+    waitForAccesses();
+}
+
+void AwaitContext::requestCancel()
+{
+    cancelled_.store(true);
+}
+
+void AwaitContext::waitForAccesses()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    accessesCV_.wait(lock, [this](){
+        return accesses_.load() == 0;
+    });
+}
+
+bool AwaitContext::isCancelled()
+{
+    return cancelled_.load();
+}
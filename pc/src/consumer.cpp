@@ -1,15 +1,17 @@
 #include "consumer.h"
-#include "sharedBuffer.h"
+#include "ISharedBuffer.h"
 
-Consumer::Consumer(SharedBuffer* buffer)
+Consumer::Consumer(ISharedBuffer* buffer)
 : IBufferActor(buffer)
 {}
 
 
-void Consumer::run(const std::chrono::milliseconds& delay)
+void Consumer::run(const ActorOptions& options)
 {
-    while(sharedBuffer_->isRunning() && rest(delay))
+    size_t count = 0;
+    while(sharedBuffer_->isRunning() && rest(count))
     {
-        sharedBuffer_->consume(this);
+        count = sharedBuffer_->consumeBatchUntil(this, options.batchSize, getDeadline(options.timeout));
+        counters_.record(count);
     }
 }
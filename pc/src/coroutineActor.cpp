@@ -0,0 +1,105 @@
+#include <exception>
+#include <algorithm>
+#include "coroutineActor.h"
+#include "BufferAwaitable.h"
+#include "RateLimiter.h"
+
+CoroutineActor::CoroutineActor(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor)
+: sharedBuffer_(sharedBuffer)
+, role_(role)
+, executor_(executor)
+, context_(std::make_shared<AwaitContext>())
+, counters_(std::make_shared<ActorCounters>())
+{}
+
+void CoroutineActor::start(const ActorOptions& options)
+{
+    counters_->delay = options.delay.count();
+    run(sharedBuffer_, role_, executor_, options, context_, counters_);
+}
+
+void CoroutineActor::requestStop()
+{
+    context_->requestCancel();
+}
+
+void CoroutineActor::join()
+{
+    context_->waitForAccesses();
+}
+
+bool CoroutineActor::isRunning() const
+{
+    return !context_->isCancelled();
+}
+
+void CoroutineActor::setDelay(const std::chrono::nanoseconds& delay)
+{
+    counters_->delay = delay.count();
+}
+
+ActorStatistics CoroutineActor::getStatistics() const
+{
+    return counters_->getStatistics();
+}
+
+void CoroutineActor::Task::promise_type::unhandled_exception()
+{
+    std::terminate();
+}
+
+bool CoroutineActor::RestAwaitable::await_ready() const
+{
+    //The coroutine is suspended even when 'time' has passed, so an actor without delay does not keep a thread busy forever.
+    return context->isCancelled();
+}
+
+void CoroutineActor::RestAwaitable::await_suspend(std::coroutine_handle<> handle) const
+{
+    executor.schedule([handle](){
+        handle.resume();
+    }, time);
+}
+
+bool CoroutineActor::RestAwaitable::await_resume() const
+{
+    return !context->isCancelled();
+}
+
+CoroutineActor::Task CoroutineActor::run(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor, ActorOptions options, std::shared_ptr<AwaitContext> context,
+                                         std::shared_ptr<ActorCounters> counters)
+{
+    ActorPacer pacer(options.pacing);
+    size_t count = 0;
+    while(true)
+    {
+        pacer.beginRest(count, std::chrono::steady_clock::now());
+        std::chrono::steady_clock::time_point time = pacer.getDeadline(counters->getDelay());
+        if (options.rateLimiter != nullptr)
+        {
+            //The limiter belongs to the caller, who can destroy it once 'join' returns, so it is only accessed inside the context.
+            if (!context->enter())
+            {
+                break;
+            }
+
+            time = std::max(time, options.rateLimiter->acquire(count));
+            context->leave();
+        }
+
+        RestAwaitable rest{executor, time, context};
+        if (!co_await rest)
+        {
+            break;
+        }
+
+        BufferAwaitable operation(sharedBuffer, role, options.batchSize, context);
+        count = co_await operation;
+        if (count == 0)
+        {
+            break;
+        }
+
+        counters->record(count);
+    }
+}
@@ -0,0 +1,207 @@
+#include <algorithm>
+#include "eventSink.h"
+
+#define DRAIN_INTERVAL 10 //The time, in milliseconds, between two consecutive drains of the ring of 'AsyncLogEventSink'.
+
+void NullEventSink::onProduced(size_t /*count*/)
+{}
+
+void NullEventSink::onConsumed(size_t /*count*/)
+{}
+
+void NullEventSink::onBufferFull()
+{}
+
+void NullEventSink::onBufferEmpty()
+{}
+
+CountingEventSink::CountingEventSink()
+: produced_(0)
+, consumed_(0)
+, bufferFull_(0)
+, bufferEmpty_(0)
+{}
+
+void CountingEventSink::onProduced(size_t count)
+{
+    produced_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void CountingEventSink::onConsumed(size_t count)
+{
+    consumed_.fetch_add(count, std::memory_order_relaxed);
+}
+
+void CountingEventSink::onBufferFull()
+{
+    bufferFull_.fetch_add(1, std::memory_order_relaxed);
+}
+
+void CountingEventSink::onBufferEmpty()
+{
+    bufferEmpty_.fetch_add(1, std::memory_order_relaxed);
+}
+
+size_t CountingEventSink::getProduced() const
+{
+    return produced_.load(std::memory_order_relaxed);
+}
+
+size_t CountingEventSink::getConsumed() const
+{
+    return consumed_.load(std::memory_order_relaxed);
+}
+
+size_t CountingEventSink::getBufferFull() const
+{
+    return bufferFull_.load(std::memory_order_relaxed);
+}
+
+size_t CountingEventSink::getBufferEmpty() const
+{
+    return bufferEmpty_.load(std::memory_order_relaxed);
+}
+
+AsyncLogEventSink::AsyncLogEventSink(std::ostream& stream, size_t capacity)
+: stream_(stream)
+, capacity_(std::max<size_t>(capacity, 1))
+, slots_(new Slot[capacity_])
+, tail_(0)
+, head_(0)
+, droppedEvents_(0)
+, quitSignal_(false)
+{
+    for(size_t i = 0; i < capacity_; ++i)
+    {
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    }
+
+    thread_ = std::thread(&AsyncLogEventSink::run, this);
+}
+
+AsyncLogEventSink::~AsyncLogEventSink()
+{
+    mutex_.lock();
+    quitSignal_ = true;
+    quitCV_.notify_all();
+    mutex_.unlock();
+
+    thread_.join();
+}
+
+void AsyncLogEventSink::onProduced(size_t count)
+{
+    push(EventType::PRODUCED, count);
+}
+
+void AsyncLogEventSink::onConsumed(size_t count)
+{
+    push(EventType::CONSUMED, count);
+}
+
+void AsyncLogEventSink::onBufferFull()
+{
+    push(EventType::BUFFER_FULL, 0);
+}
+
+void AsyncLogEventSink::onBufferEmpty()
+{
+    push(EventType::BUFFER_EMPTY, 0);
+}
+
+size_t AsyncLogEventSink::getDroppedEvents() const
+{
+    return droppedEvents_.load(std::memory_order_relaxed);
+}
+
+void AsyncLogEventSink::push(EventType type, size_t count)
+{
+    size_t position = tail_.load(std::memory_order_relaxed);
+    while(true)
+    {
+        Slot& slot = slots_[position % capacity_];
+        size_t sequence = slot.sequence.load(std::memory_order_acquire);
+        if (sequence == position)
+        {
+            if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+            {
+                slot.type = type;
+                slot.count = count;
+                slot.sequence.store(position + 1, std::memory_order_release);
+                return;
+            }
+        }
+        else if (sequence < position)
+        {
+            droppedEvents_.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+        else
+        {
+            position = tail_.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void AsyncLogEventSink::drain()
+{
+    bool written = false;
+    Slot* slot = &slots_[head_ % capacity_];
+    while(slot->sequence.load(std::memory_order_acquire) == head_ + 1)
+    {
+        switch(slot->type)
+        {
+            case EventType::PRODUCED:
+                write("Pushing", slot->count);
+                break;
+            case EventType::CONSUMED:
+                write("Poping", slot->count);
+                break;
+            case EventType::BUFFER_FULL:
+                stream_ << "Buffer full. Waiting for someone to consume." << '\n';
+                break;
+            case EventType::BUFFER_EMPTY:
+                stream_ << "Buffer empty. Waiting for someone to push." << '\n';
+                break;
+        }
+
+        slot->sequence.store(head_ + capacity_, std::memory_order_release);
+        head_++;
+        slot = &slots_[head_ % capacity_];
+        written = true;
+    }
+
+    if (written)
+    {
+        stream_.flush();
+    }
+}
+
+void AsyncLogEventSink::write(const char* action, size_t count)
+{
+    //A single item keeps the message written before the batches existed.
+    if (count == 1)
+    {
+        stream_ << action << " value" << '\n';
+        return;
+    }
+
+    stream_ << action << ' ' << count << " values" << '\n';
+}
+
+void AsyncLogEventSink::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!quitSignal_)
+    {
+        lock.unlock();
+        drain();
+        lock.lock();
+        quitCV_.wait_for(lock, std::chrono::milliseconds(DRAIN_INTERVAL), [this](){
+            return quitSignal_;
+        });
+    }
+    lock.unlock();
+
+    drain();
+}
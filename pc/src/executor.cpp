@@ -0,0 +1,81 @@
+#include <algorithm>
+#include "executor.h"
+
+bool Executor::TimedTask::operator>(const TimedTask& other) const
+{
+    return time > other.time || (time == other.time && sequence > other.sequence);
+}
+
+Executor::Executor(size_t numberOfThreads)
+: sequence_(0)
+, quitSignal_(false)
+{
+    for(size_t i = 0; i < numberOfThreads; ++i)
+    {
+        threads_.emplace_back(&Executor::run, this);
+    }
+}
+
+Executor::~Executor()
+{
+    {
+        std::scoped_lock lock(mutex_);
+        quitSignal_ = true;
+        tasksCV_.notify_all();
+    }
+
+    for(auto& thread: threads_)
+    {
+        thread.join();
+    }
+}
+
+void Executor::schedule(const Task& task, const std::chrono::steady_clock::time_point& time)
+{
+    std::scoped_lock lock(mutex_);
+    bool earliest = tasks_.empty() || time < tasks_.top().time;
+    tasks_.push(TimedTask{time, sequence_++, task});
+
+    //The waiting threads only need to be woken up when the new task is due before the one they are waiting for.
+    if (earliest)
+    {
+        tasksCV_.notify_one();
+    }
+}
+
+void Executor::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(!quitSignal_)
+    {
+        if (tasks_.empty())
+        {
+            tasksCV_.wait(lock);
+            continue;
+        }
+
+        std::chrono::steady_clock::time_point time = tasks_.top().time;
+        if (time > std::chrono::steady_clock::now())
+        {
+            tasksCV_.wait_until(lock, time);
+            continue;
+        }
+
+        Task task = tasks_.top().task;
+        tasks_.pop();
+        if (!tasks_.empty() && tasks_.top().time <= std::chrono::steady_clock::now())
+        {
+            tasksCV_.notify_one(); //Another thread can run the next due task meanwhile.
+        }
+
+        lock.unlock();
+        task();
+        lock.lock();
+    }
+}
+
+Executor& Executor::getDefault()
+{
+    static Executor executor(std::max(1u, std::thread::hardware_concurrency()));
+    return executor;
+}
@@ -0,0 +1,56 @@
+#include <algorithm>
+#include "inlineSharedBuffer.h"
+
+InlineSharedBuffer::InlineSharedBuffer(void* items, size_t size, std::unique_ptr<IInlineItems> operations, const BufferOptions& options)
+: SharedBuffer(size, options)
+, items_(static_cast<char*>(items))
+, operations_(std::move(operations))
+{
+    calculateCurrentIndex();
+}
+
+void InlineSharedBuffer::fillItems(size_t first, size_t count)
+{
+    forEachRange(first, count, [this](void* items, size_t rangeCount){
+        operations_->fill(items, rangeCount);
+    });
+}
+
+void InlineSharedBuffer::emptyItems(size_t first, size_t count)
+{
+    forEachRange(first, count, [this](void* items, size_t rangeCount){
+        operations_->empty(items, rangeCount);
+    });
+}
+
+void InlineSharedBuffer::visitItems(size_t first, size_t count, const ItemVisitor& visitor)
+{
+    forEachRange(first, count, [this, &visitor](void* items, size_t rangeCount){
+        operations_->visit(items, rangeCount, visitor);
+    });
+}
+
+bool InlineSharedBuffer::isItemFilled(size_t index) const
+{
+    return operations_->isFilled(getItem(index));
+}
+
+void* InlineSharedBuffer::getItem(size_t index) const
+{
+    return items_ + index * operations_->getItemSize();
+}
+
+template <class Function>
+void InlineSharedBuffer::forEachRange(size_t first, size_t count, Function function) const
+{
+    size_t firstRange = std::min(count, size_ - first);
+    if (firstRange > 0)
+    {
+        function(getItem(first), firstRange);
+    }
+
+    if (count > firstRange)
+    {
+        function(getItem(0), count - firstRange);
+    }
+}
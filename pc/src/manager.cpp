@@ -1,119 +1,439 @@
 #include "manager.h"
+#include "pointerSharedBuffer.h"
+#include "ringBuffer.h"
 
-SharedBuffer* ProducerConsumerManager::sharedBuffer_;
+ProducerConsumerManager::ProducerConsumerManager()
+: sharedBuffer_(nullptr)
+, awaitContext_(std::make_shared<AwaitContext>())
+, removedConsumers_(0)
+, removedProducers_(0)
+, externalConsumers_(false)
+, externalProducers_(false)
+, nextHandle_(1)
+{
+    awaitContext_->cancel();
+
+    //The defaults are constructed before any manager, so they are destroyed after the managers that are static objects, like the one of 'IPC'.
+    ThreadCache::getDefault();
+    ActorAllocator::getDefault();
+}
+
+ProducerConsumerManager::~ProducerConsumerManager()
+{
+    if (sharedBuffer_)
+    {
+        stop();
+    }
+}
+
+void ProducerConsumerManager::start(const ProducerConsumer::ItemsBuffer& buffer, const BufferOptions& options)
+{
+    start(createBuffer(buffer, options));
+}
 
-std::list<Consumer* > ProducerConsumerManager::consumers_;
-std::list<Producer* > ProducerConsumerManager::producers_;
-std::mutex ProducerConsumerManager::mutexConsumers_;
-std::mutex ProducerConsumerManager::mutexProducers_;
+IItemsBuffer* ProducerConsumerManager::createBuffer(const ProducerConsumer::ItemsBuffer& buffer, const BufferOptions& options)
+{
+    //The ring needs two slots at least: with a single one, the sequence of a released slot is the one of an empty slot at the next position.
+    if (options.backend == BufferBackend::LOCK_FREE && buffer.size() >= 2)
+    {
+        return new RingBuffer(buffer, options);
+    }
 
-void ProducerConsumerManager::start(const IPC::ItemsBuffer& buffer)
+    return new PointerSharedBuffer(buffer, options);
+}
+
+void ProducerConsumerManager::start(ISharedBuffer* sharedBuffer)
 {
-    sharedBuffer_ = new SharedBuffer(buffer);
+    sharedBuffer_ = sharedBuffer;
+    externalConsumers_ = false;
+    externalProducers_ = false;
+    awaitContext_ = std::make_shared<AwaitContext>();
 }
 
-void ProducerConsumerManager::addProducer(const std::chrono::milliseconds& delay)
+IActor* ProducerConsumerManager::createActor(ActorRole role, const ActorOptions& options)
+{
+    switch(options.execution)
+    {
+        case ActorExecution::SHARED_POOL:
+            return new PooledActor(sharedBuffer_, role, Executor::getDefault());
+        case ActorExecution::COROUTINE:
+            return new CoroutineActor(sharedBuffer_, role, Executor::getDefault());
+        case ActorExecution::DEDICATED_THREAD:
+            break;
+    }
+
+    if (role == ActorRole::PRODUCER)
+    {
+        return new Producer(sharedBuffer_);
+    }
+
+    return new Consumer(sharedBuffer_);
+}
+
+ProducerConsumer::ActorHandle ProducerConsumerManager::addProducer(const ActorOptions& options)
 {
     std::scoped_lock lock(mutexProducers_);
-    if (!sharedBuffer_->isRunning())
+    if (!sharedBuffer_ || !sharedBuffer_->isRunning())
     {
-        return;
+        return 0;
     }
 
-    Producer* producer = new Producer(sharedBuffer_);
-    producer->start(delay);
-    producers_.push_back(producer);
+    IActor* producer = createActor(ActorRole::PRODUCER, options);
+    sharedBuffer_->setNumberOfProducers(producers_.size() + removedProducers_ + 1);
+    producer->start(options);
+    ProducerConsumer::ActorHandle handle = nextHandle_++;
+    producerIndex_[handle] = producers_.insert(producers_.end(), ManagedActor{handle, producer});
+    return handle;
 }
 
-void ProducerConsumerManager::addConsumer(const std::chrono::milliseconds& delay)
+ProducerConsumer::ActorHandle ProducerConsumerManager::addConsumer(const ActorOptions& options)
 {
     std::scoped_lock lock(mutexConsumers_);
-    if (!sharedBuffer_->isRunning())
+    if (!sharedBuffer_ || !sharedBuffer_->isRunning())
     {
-        return;
+        return 0;
     }
-    Consumer* consumer = new Consumer(sharedBuffer_);
-    consumer->start(delay);
-    consumers_.push_back(consumer);
+
+    IActor* consumer = createActor(ActorRole::CONSUMER, options);
+    sharedBuffer_->setNumberOfConsumers(consumers_.size() + removedConsumers_ + 1);
+    consumer->start(options);
+    ProducerConsumer::ActorHandle handle = nextHandle_++;
+    consumerIndex_[handle] = consumers_.insert(consumers_.end(), ManagedActor{handle, consumer});
+    return handle;
 }
 
-void ProducerConsumerManager::removeConsumer()
+std::future<void> ProducerConsumerManager::removeConsumer()
 {
     std::scoped_lock lock(mutexConsumers_);
-    ConsumerIterator consumerIterator = consumers_.begin();
-    if (consumerIterator == consumers_.end())
+    if (consumers_.empty())
     {
-        return;
+        return destroyed();
     }
 
-    removeConsumer(consumerIterator);
+    return removeConsumer(consumers_.begin());
 }
 
-void ProducerConsumerManager::removeConsumer(const ConsumerIterator& consumerIterator)
+std::future<void> ProducerConsumerManager::removeProducer()
 {
-    if (consumerIterator == consumers_.end())
+    std::scoped_lock lock(mutexProducers_);
+    if (producers_.empty())
     {
-        return;
+        return destroyed();
     }
 
-    Consumer* consumer = *(consumerIterator);
-    consumer->stop();
-    consumers_.erase(consumerIterator);
-    delete consumer;
+    return removeProducer(producers_.begin());
 }
 
-void ProducerConsumerManager::removeProducer()
+std::future<void> ProducerConsumerManager::remove(ProducerConsumer::ActorHandle handle)
 {
-    std::scoped_lock lock(mutexProducers_);
-    ProducerIterator producerIterator = producers_.begin();
-    if (producerIterator == producers_.end())
     {
-        return;
+        std::scoped_lock lock(mutexProducers_);
+        auto producer = producerIndex_.find(handle);
+        if (producer != producerIndex_.end())
+        {
+            return removeProducer(producer->second);
+        }
+    }
+
+    std::scoped_lock lock(mutexConsumers_);
+    auto consumer = consumerIndex_.find(handle);
+    if (consumer != consumerIndex_.end())
+    {
+        return removeConsumer(consumer->second);
     }
 
-    removeProducer(producerIterator);
+    return destroyed();
+}
+
+bool ProducerConsumerManager::setDelay(ProducerConsumer::ActorHandle handle, const std::chrono::nanoseconds& delay)
+{
+    return visit(handle, [&delay](IActor& actor){
+        actor.setDelay(delay);
+    });
+}
+
+std::optional<ActorStatistics> ProducerConsumerManager::getStatistics(ProducerConsumer::ActorHandle handle)
+{
+    std::optional<ActorStatistics> statistics;
+    visit(handle, [&statistics](IActor& actor){
+        statistics = actor.getStatistics();
+    });
+
+    return statistics;
 }
 
-void ProducerConsumerManager::removeProducer(const ProducerIterator& producerIterator)
+bool ProducerConsumerManager::visit(ProducerConsumer::ActorHandle handle, const std::function<void(IActor&)>& visitor)
 {
-    if (producerIterator == producers_.end())
     {
-        return;
+        std::scoped_lock lock(mutexProducers_);
+        auto producer = producerIndex_.find(handle);
+        if (producer != producerIndex_.end())
+        {
+            visitor(*producer->second->actor);
+            return true;
+        }
     }
 
-    Producer* producer = *(producerIterator);
-    producer->stop();
+    std::scoped_lock lock(mutexConsumers_);
+    auto consumer = consumerIndex_.find(handle);
+    if (consumer != consumerIndex_.end())
+    {
+        visitor(*consumer->second->actor);
+        return true;
+    }
+
+    return false;
+}
+
+std::future<void> ProducerConsumerManager::removeConsumer(const ActorList::iterator& consumerIterator)
+{
+    IActor* consumer = consumerIterator->actor;
+    consumerIndex_.erase(consumerIterator->handle);
+    consumers_.erase(consumerIterator);
+    consumer->requestStop();
+    sharedBuffer_->notify();
+    return reapConsumer(consumer);
+}
+
+std::future<void> ProducerConsumerManager::removeProducer(const ActorList::iterator& producerIterator)
+{
+    IActor* producer = producerIterator->actor;
+    producerIndex_.erase(producerIterator->handle);
     producers_.erase(producerIterator);
-    delete producer;
+    producer->requestStop();
+    sharedBuffer_->notify();
+    return reapProducer(producer);
+}
+
+std::future<void> ProducerConsumerManager::destroyed()
+{
+    std::promise<void> destroyed;
+    destroyed.set_value();
+    return destroyed.get_future();
+}
+
+std::future<void> ProducerConsumerManager::reapConsumer(IActor* consumer)
+{
+    //The buffer keeps counting the consumer until it is joined, since it can still be consuming items.
+    ++removedConsumers_;
+    return reaper_.reap(consumer, [this](){
+        std::scoped_lock lock(mutexConsumers_);
+        --removedConsumers_;
+        sharedBuffer_->setNumberOfConsumers(consumers_.size() + removedConsumers_);
+    });
+}
+
+std::future<void> ProducerConsumerManager::reapProducer(IActor* producer)
+{
+    //The buffer keeps counting the producer until it is joined, since it can still be producing items.
+    ++removedProducers_;
+    return reaper_.reap(producer, [this](){
+        std::scoped_lock lock(mutexProducers_);
+        --removedProducers_;
+        sharedBuffer_->setNumberOfProducers(producers_.size() + removedProducers_);
+    });
 }
 
 void ProducerConsumerManager::removeConsumers()
 {
-    std::scoped_lock lock(mutexConsumers_);
-    while(!consumers_.empty())
+    std::vector<std::future<void>> destroyed;
     {
-        removeConsumer(consumers_.begin());
+        std::scoped_lock lock(mutexConsumers_);
+        requestStop(consumers_);
+        if (sharedBuffer_)
+        {
+            sharedBuffer_->notify();
+        }
+
+        for(auto& consumer: consumers_)
+        {
+            destroyed.push_back(reapConsumer(consumer.actor));
+        }
+        consumers_.clear();
+        consumerIndex_.clear();
+    }
+
+    for(auto& future: destroyed)
+    {
+        future.wait();
     }
 }
 
 void ProducerConsumerManager::removeProducers()
 {
-    std::scoped_lock lock(mutexProducers_);
-    while(!producers_.empty())
+    std::vector<std::future<void>> destroyed;
+    {
+        std::scoped_lock lock(mutexProducers_);
+        requestStop(producers_);
+        if (sharedBuffer_)
+        {
+            sharedBuffer_->notify();
+        }
+
+        for(auto& producer: producers_)
+        {
+            destroyed.push_back(reapProducer(producer.actor));
+        }
+        producers_.clear();
+        producerIndex_.clear();
+    }
+
+    for(auto& future: destroyed)
+    {
+        future.wait();
+    }
+}
+
+void ProducerConsumerManager::requestStop(const ActorList& actors)
+{
+    for(auto& actor: actors)
     {
-        removeProducer(producers_.begin());
+        actor.actor->requestStop();
     }
 }
 
+void ProducerConsumerManager::joinAndDelete(ActorList& actors, ActorIndex& index)
+{
+    for(auto& actor: actors)
+    {
+        actor.actor->join();
+        delete actor.actor;
+    }
+
+    actors.clear();
+    index.clear();
+}
+
 void ProducerConsumerManager::stop()
 {
-    removeProducers();
-    removeConsumers();
-    sharedBuffer_->stop();
+    if (!sharedBuffer_)
+    {
+        return;
+    }
+
+    {
+        //All the actors are signaled, and the buffer is stopped once, before waiting for any of them. Stopping the buffer also wakes up
+        //the callers of 'produceUntil' and 'consumeUntil'.
+        std::scoped_lock lock(mutexProducers_, mutexConsumers_);
+        requestStop(producers_);
+        requestStop(consumers_);
+        awaitContext_->requestCancel();
+        sharedBuffer_->stop();
+        joinAndDelete(producers_, producerIndex_);
+        joinAndDelete(consumers_, consumerIndex_);
+    }
+
+    //Waits for the callers of the try and until calls, and for the awaitables, that are still inside the buffer. Once the context is cancelled,
+    //no new access enters it.
+    awaitContext_->waitForAccesses();
+
+    //The actors removed before are still accessing the buffer until the reaper joins them.
+    reaper_.drain();
+
+    //The buffer is cleared under the mutexes of the actors, so 'addProducer', 'addConsumer' and their removals see either the buffer or nothing.
+    std::scoped_lock lock(mutexProducers_, mutexConsumers_);
+    sharedBuffer_->setNumberOfProducers(0);
+    sharedBuffer_->setNumberOfConsumers(0);
     delete sharedBuffer_;
+    sharedBuffer_ = nullptr;
+}
+
+BufferAwaitable ProducerConsumerManager::produce(size_t count)
+{
+    addExternalCallers(ActorRole::PRODUCER);
+    return BufferAwaitable(sharedBuffer_, ActorRole::PRODUCER, count, awaitContext_);
+}
+
+BufferAwaitable ProducerConsumerManager::consume(size_t count)
+{
+    addExternalCallers(ActorRole::CONSUMER);
+    return BufferAwaitable(sharedBuffer_, ActorRole::CONSUMER, count, awaitContext_);
+}
+
+size_t ProducerConsumerManager::tryProduce(size_t count)
+{
+    return callBuffer(ActorRole::PRODUCER, [this, count](){
+        return sharedBuffer_->tryProduceBatch(count);
+    });
+}
+
+size_t ProducerConsumerManager::tryConsume(size_t count)
+{
+    return callBuffer(ActorRole::CONSUMER, [this, count](){
+        return sharedBuffer_->tryConsumeBatch(count);
+    });
+}
+
+size_t ProducerConsumerManager::produceUntil(size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return callBuffer(ActorRole::PRODUCER, [this, count, &deadline](){
+        return sharedBuffer_->produceBatchUntil(nullptr, count, deadline);
+    });
+}
+
+size_t ProducerConsumerManager::consumeUntil(size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return callBuffer(ActorRole::CONSUMER, [this, count, &deadline](){
+        return sharedBuffer_->consumeBatchUntil(nullptr, count, deadline);
+    });
+}
+
+size_t ProducerConsumerManager::callBuffer(ActorRole role, const std::function<size_t()>& operation)
+{
+    std::shared_ptr<AwaitContext> context = awaitContext_;
+    if (!context->enter())
+    {
+        return 0;
+    }
+
+    markExternalCallers(role);
+    size_t count = operation();
+    context->leave();
+    return count;
+}
+
+void ProducerConsumerManager::addExternalCallers(ActorRole role)
+{
+    std::shared_ptr<AwaitContext> context = awaitContext_;
+    if (context->enter())
+    {
+        markExternalCallers(role);
+        context->leave();
+    }
+}
+
+void ProducerConsumerManager::markExternalCallers(ActorRole role)
+{
+    std::atomic<bool>& externalCallers = role == ActorRole::PRODUCER ? externalProducers_ : externalConsumers_;
+    if (!externalCallers.load(std::memory_order_acquire))
+    {
+        sharedBuffer_->addExternalCallers(role);
+        externalCallers.store(true, std::memory_order_release);
+    }
 }
 
 size_t ProducerConsumerManager::getCurrentIndex()
 {
-    return sharedBuffer_->getCurrentIndex();
+    std::shared_ptr<AwaitContext> context = awaitContext_;
+    if (!context->enter())
+    {
+        return 0;
+    }
+
+    size_t currentIndex = sharedBuffer_->getCurrentIndex();
+    context->leave();
+    return currentIndex;
+}
+
+BufferStatistics ProducerConsumerManager::getStatistics()
+{
+    std::shared_ptr<AwaitContext> context = awaitContext_;
+    if (!context->enter())
+    {
+        return BufferStatistics();
+    }
+
+    BufferStatistics statistics = sharedBuffer_->getStatistics();
+    context->leave();
+    return statistics;
 }
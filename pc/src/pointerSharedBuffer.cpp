@@ -0,0 +1,37 @@
+#include "pointerSharedBuffer.h"
+
+PointerSharedBuffer::PointerSharedBuffer(const std::vector<IBufferItem*>& buffer, const BufferOptions& options)
+: SharedBuffer(buffer.size(), options)
+, buffer_(buffer)
+{
+    calculateCurrentIndex();
+}
+
+void PointerSharedBuffer::fillItems(size_t first, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        buffer_[getSlot(first, i)]->fill();
+    }
+}
+
+void PointerSharedBuffer::emptyItems(size_t first, size_t count)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        buffer_[getSlot(first, i)]->empty();
+    }
+}
+
+void PointerSharedBuffer::visitItems(size_t first, size_t count, const ItemVisitor& visitor)
+{
+    for(size_t i = 0; i < count; ++i)
+    {
+        visitor(*(buffer_[getSlot(first, i)]));
+    }
+}
+
+bool PointerSharedBuffer::isItemFilled(size_t index) const
+{
+    return *(buffer_[index]);
+}
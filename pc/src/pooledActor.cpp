@@ -0,0 +1,108 @@
+#include <algorithm>
+#include "pooledActor.h"
+#include "ISharedBuffer.h"
+#include "RateLimiter.h"
+
+PooledActor::PooledActor(ISharedBuffer* sharedBuffer, ActorRole role, Executor& executor)
+: state_(new State{sharedBuffer, role, executor, ActorOptions(std::chrono::milliseconds(0)), {}, ActorPacer(ActorPacing::AFTER_OPERATION),
+                   false, false, {}, {}})
+{}
+
+void PooledActor::start(const ActorOptions& options)
+{
+    state_->options = options;
+    state_->counters.delay = options.delay.count();
+    state_->pacer = ActorPacer(options.pacing);
+    schedule(state_, std::chrono::steady_clock::now());
+}
+
+void PooledActor::requestStop()
+{
+    std::scoped_lock lock(state_->mutex);
+    state_->quitSignal = true;
+}
+
+void PooledActor::join()
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->stepCV.wait(lock, [this](){
+        return !state_->stepping;
+    });
+}
+
+bool PooledActor::isRunning() const
+{
+    std::scoped_lock lock(state_->mutex);
+    return !state_->quitSignal;
+}
+
+void PooledActor::setDelay(const std::chrono::nanoseconds& delay)
+{
+    state_->counters.delay = delay.count();
+}
+
+ActorStatistics PooledActor::getStatistics() const
+{
+    return state_->counters.getStatistics();
+}
+
+void PooledActor::schedule(const std::shared_ptr<State>& state, const std::chrono::steady_clock::time_point& time)
+{
+    state->executor.schedule([state](){
+        step(state);
+    }, time);
+}
+
+void PooledActor::step(const std::shared_ptr<State>& state)
+{
+    {
+        std::scoped_lock lock(state->mutex);
+        if (state->quitSignal)
+        {
+            return;
+        }
+
+        state->stepping = true;
+    }
+
+    size_t count = 0;
+    bool running = state->sharedBuffer->isRunning();
+    if (running)
+    {
+        count = state->role == ActorRole::PRODUCER ? state->sharedBuffer->retryProduceBatch(state->options.batchSize)
+                                                   : state->sharedBuffer->tryConsumeBatch(state->options.batchSize);
+        state->counters.record(count);
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point next = now;
+    if (count > 0)
+    {
+        state->pacer.beginRest(count, next);
+        next = state->pacer.getDeadline(state->counters.getDelay());
+    }
+
+    if (state->options.rateLimiter != nullptr)
+    {
+        next = std::max(next, state->options.rateLimiter->acquire(count));
+    }
+
+    std::scoped_lock lock(state->mutex);
+    state->stepping = false;
+    if (state->quitSignal || !running)
+    {
+        state->stepCV.notify_all();
+        return;
+    }
+
+    //The buffer calls the waiter while it may be locked, so the waiter only schedules the step. When the buffer became ready meanwhile,
+    //the waiter is not registered and the step is scheduled straight away.
+    if (count == 0 && next <= now && state->sharedBuffer->addWaiter(state->role, [state](){
+        schedule(state, std::chrono::steady_clock::now());
+    }))
+    {
+        return;
+    }
+
+    schedule(state, next);
+}
@@ -0,0 +1,108 @@
+#include <algorithm>
+#include "pooledStageWorker.h"
+#include "RateLimiter.h"
+
+PooledStageWorker::PooledStageWorker(PipelineStage& stage, Executor& executor)
+: state_(new State{stage, executor, ActorOptions(std::chrono::milliseconds(0)), {}, ActorPacer(ActorPacing::AFTER_OPERATION), false, false, {}, {}})
+{}
+
+void PooledStageWorker::start(const ActorOptions& options)
+{
+    state_->options = options;
+    state_->counters.delay = options.delay.count();
+    state_->pacer = ActorPacer(options.pacing);
+    schedule(state_, std::chrono::steady_clock::now());
+}
+
+void PooledStageWorker::requestStop()
+{
+    std::scoped_lock lock(state_->mutex);
+    state_->quitSignal = true;
+}
+
+void PooledStageWorker::join()
+{
+    std::unique_lock<std::mutex> lock(state_->mutex);
+    state_->stepCV.wait(lock, [this](){
+        return !state_->stepping;
+    });
+}
+
+bool PooledStageWorker::isRunning() const
+{
+    std::scoped_lock lock(state_->mutex);
+    return !state_->quitSignal;
+}
+
+void PooledStageWorker::setDelay(const std::chrono::nanoseconds& delay)
+{
+    state_->counters.delay = delay.count();
+}
+
+ActorStatistics PooledStageWorker::getStatistics() const
+{
+    return state_->counters.getStatistics();
+}
+
+void PooledStageWorker::schedule(const std::shared_ptr<State>& state, const std::chrono::steady_clock::time_point& time)
+{
+    state->executor.schedule([state](){
+        step(state);
+    }, time);
+}
+
+void PooledStageWorker::step(const std::shared_ptr<State>& state)
+{
+    {
+        std::scoped_lock lock(state->mutex);
+        if (state->quitSignal)
+        {
+            return;
+        }
+
+        state->stepping = true;
+    }
+
+    PipelineStage& stage = state->stage;
+    size_t count = 0;
+    ActorRole waitingRole = ActorRole::CONSUMER;
+    bool running = stage.input->isRunning() && stage.output->isRunning();
+    if (running)
+    {
+        std::scoped_lock stageLock(stage.mutex);
+        count = stage.moveItems(state->options.batchSize, waitingRole);
+        state->counters.record(count);
+    }
+
+    std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+    std::chrono::steady_clock::time_point next = now;
+    if (count > 0)
+    {
+        state->pacer.beginRest(count, next);
+        next = state->pacer.getDeadline(state->counters.getDelay());
+    }
+
+    if (state->options.rateLimiter != nullptr)
+    {
+        next = std::max(next, state->options.rateLimiter->acquire(count));
+    }
+
+    std::scoped_lock lock(state->mutex);
+    state->stepping = false;
+    if (state->quitSignal || !running)
+    {
+        state->stepCV.notify_all();
+        return;
+    }
+
+    //As for 'PooledActor', the waiter only schedules the step, and it is not registered if the buffer became ready meanwhile.
+    IItemsBuffer* waitingBuffer = waitingRole == ActorRole::PRODUCER ? stage.output : stage.input;
+    if (count == 0 && next <= now && waitingBuffer->addWaiter(waitingRole, [state](){
+        schedule(state, std::chrono::steady_clock::now());
+    }))
+    {
+        return;
+    }
+
+    schedule(state, next);
+}
@@ -1,14 +1,16 @@
 #include "producer.h"
-#include "sharedBuffer.h"
+#include "ISharedBuffer.h"
 
-Producer::Producer(SharedBuffer* buffer)
+Producer::Producer(ISharedBuffer* buffer)
 : IBufferActor(buffer)
 {}
 
-void Producer::run(const std::chrono::milliseconds& delay)
+void Producer::run(const ActorOptions& options)
 {
-    while(sharedBuffer_->isRunning() && rest(delay))
+    size_t count = 0;
+    while(sharedBuffer_->isRunning() && rest(count))
     {
-        sharedBuffer_->produce(this);
+        count = sharedBuffer_->produceBatchUntil(this, options.batchSize, getDeadline(options.timeout));
+        counters_.record(count);
     }
 }
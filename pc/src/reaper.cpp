@@ -0,0 +1,75 @@
+#include "reaper.h"
+
+Reaper::Reaper()
+: pending_(0)
+, quitSignal_(false)
+{}
+
+Reaper::~Reaper()
+{
+    drain();
+
+    {
+        std::scoped_lock lock(mutex_);
+        quitSignal_ = true;
+        actorsCV_.notify_all();
+    }
+
+    if (thread_.joinable())
+    {
+        thread_.join();
+    }
+}
+
+std::future<void> Reaper::reap(IActor* actor, const std::function<void()>& onDestroyed)
+{
+    std::scoped_lock lock(mutex_);
+    if (!thread_.joinable())
+    {
+        thread_ = std::thread(&Reaper::run, this);
+    }
+
+    actors_.push_back(RemovedActor{actor, onDestroyed, std::promise<void>()});
+    ++pending_;
+    actorsCV_.notify_one();
+    return actors_.back().destroyed.get_future();
+}
+
+void Reaper::drain()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    drainedCV_.wait(lock, [this](){
+        return pending_ == 0;
+    });
+}
+
+void Reaper::run()
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true)
+    {
+        actorsCV_.wait(lock, [this](){
+            return quitSignal_ || !actors_.empty();
+        });
+
+        if (actors_.empty())
+        {
+            return;
+        }
+
+        RemovedActor removedActor = std::move(actors_.front());
+        actors_.pop_front();
+        lock.unlock();
+
+        removedActor.actor->join();
+        delete removedActor.actor;
+        removedActor.onDestroyed();
+        removedActor.destroyed.set_value();
+
+        lock.lock();
+        if (--pending_ == 0)
+        {
+            drainedCV_.notify_all();
+        }
+    }
+}
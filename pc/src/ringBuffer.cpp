@@ -0,0 +1,575 @@
+#include <thread>
+#include "ringBuffer.h"
+#include "IActor.h"
+
+RingBuffer::RingBuffer(const std::vector<IBufferItem*>& buffer, const BufferOptions& options)
+: head_(0)
+, singleConsumer_(false)
+, consumerInSinglePath_(false)
+, tail_(0)
+, singleProducer_(false)
+, producerInSinglePath_(false)
+, numberOfConsumers_(0)
+, numberOfProducers_(0)
+, externalConsumers_(false)
+, externalProducers_(false)
+, notFullWaiters_(0)
+, notEmptyWaiters_(0)
+, spuriousWakeups_(0)
+, droppedItems_(0)
+, quitSignal_(false)
+, capacity_(buffer.size())
+, overflowPolicy_(options.overflowPolicy)
+, slots_(options.slotLayout == SlotLayout::COMPACT ? new Slot[buffer.size()] : nullptr)
+, paddedSlots_(options.slotLayout == SlotLayout::PADDED ? new PaddedSlot[buffer.size()] : nullptr)
+, eventSink_(options.eventSink ? options.eventSink : &nullEventSink_)
+, waitStrategy_(IWaitStrategy::create(options.waitStrategy))
+, parkedSpuriousWakeups_(0)
+{
+    size_t filledItems = 0;
+    for(; (filledItems < capacity_ && *(buffer[filledItems])); filledItems++);
+
+    for(size_t i = 0; i < capacity_; ++i)
+    {
+        Slot& slot = getSlot(i);
+        slot.item = buffer[i];
+        slot.sequence.store(i < filledItems ? i + 1 : i, std::memory_order_relaxed);
+    }
+
+    tail_.store(filledItems, std::memory_order_relaxed);
+}
+
+RingBuffer::Slot& RingBuffer::getSlot(size_t position) const
+{
+    return paddedSlots_ ? paddedSlots_[position % capacity_] : slots_[position % capacity_];
+}
+
+size_t RingBuffer::countAvailable(size_t position, size_t count, size_t sequenceOffset) const
+{
+    size_t available = 0;
+    while(available < count && getSlot(position + available).sequence.load(std::memory_order_acquire) == position + available + sequenceOffset)
+    {
+        available++;
+    }
+
+    return available;
+}
+
+size_t RingBuffer::reserve(std::atomic<size_t>& index, const std::atomic<bool>& single, std::atomic<bool>& inSinglePath,
+                           size_t& position, size_t count, size_t sequenceOffset)
+{
+    if (single.load(std::memory_order_relaxed))
+    {
+        //The flag is raised before checking 'single' again, so 'disableSinglePath' either sees it or this thread sees the path disabled.
+        inSinglePath.store(true);
+        if (single.load())
+        {
+            position = index.load(std::memory_order_relaxed);
+            size_t available = countAvailable(position, count, sequenceOffset);
+            index.store(position + available, std::memory_order_relaxed);
+            inSinglePath.store(false, std::memory_order_release);
+            return available;
+        }
+        inSinglePath.store(false, std::memory_order_relaxed);
+    }
+
+    position = index.load(std::memory_order_relaxed);
+    while(true)
+    {
+        size_t available = countAvailable(position, count, sequenceOffset);
+        if (available > 0)
+        {
+            if (index.compare_exchange_weak(position, position + available, std::memory_order_relaxed))
+            {
+                return available;
+            }
+        }
+        else if (getSlot(position).sequence.load(std::memory_order_acquire) < position + sequenceOffset)
+        {
+            return 0; //The slot has not been released yet by the other role.
+        }
+        else
+        {
+            position = index.load(std::memory_order_relaxed);
+        }
+    }
+}
+
+void RingBuffer::disableSinglePath(std::atomic<bool>& single, const std::atomic<bool>& inSinglePath)
+{
+    single.store(false);
+    while(inSinglePath.load())
+    {
+        std::this_thread::yield();
+    }
+}
+
+void RingBuffer::setNumberOfProducers(size_t numberOfProducers)
+{
+    std::scoped_lock lock(mutexSinglePaths_);
+    numberOfProducers_ = numberOfProducers;
+    updateSinglePaths();
+}
+
+void RingBuffer::setNumberOfConsumers(size_t numberOfConsumers)
+{
+    std::scoped_lock lock(mutexSinglePaths_);
+    numberOfConsumers_ = numberOfConsumers;
+    updateSinglePaths();
+}
+
+void RingBuffer::addExternalCallers(ActorRole role)
+{
+    std::scoped_lock lock(mutexSinglePaths_);
+    if (role == ActorRole::PRODUCER)
+    {
+        externalProducers_ = true;
+    }
+    else
+    {
+        externalConsumers_ = true;
+    }
+    updateSinglePaths();
+}
+
+void RingBuffer::updateSinglePaths()
+{
+    if (numberOfProducers_ == 1 && !externalProducers_)
+    {
+        singleProducer_.store(true);
+    }
+    else
+    {
+        disableSinglePath(singleProducer_, producerInSinglePath_);
+    }
+
+    if (numberOfConsumers_ == 1 && !externalConsumers_ && !dropsOldest())
+    {
+        singleConsumer_.store(true);
+    }
+    else
+    {
+        disableSinglePath(singleConsumer_, consumerInSinglePath_);
+    }
+}
+
+bool RingBuffer::dropsOldest() const
+{
+    return overflowPolicy_ == OverflowPolicy::DROP_OLDEST || overflowPolicy_ == OverflowPolicy::OVERWRITE;
+}
+
+size_t RingBuffer::reserveToProduce(size_t& position, size_t count, bool retried)
+{
+    size_t reserved = reserve(tail_, singleProducer_, producerInSinglePath_, position, count, 0);
+    if (reserved == 0 && dropsOldest())
+    {
+        reserved = dropOldest(position, count);
+    }
+
+    if (overflowPolicy_ == OverflowPolicy::REJECT && !retried)
+    {
+        droppedItems_.fetch_add(count - reserved, std::memory_order_relaxed); //Including the items of a batch that did not fit.
+    }
+
+    return reserved;
+}
+
+size_t RingBuffer::dropOldest(size_t& position, size_t count)
+{
+    size_t dropped = 0;
+    while(dropped < count)
+    {
+        size_t head = head_.load(std::memory_order_relaxed);
+        size_t tail = tail_.load(std::memory_order_relaxed);
+        if ((dropped > 0 && tail != position + dropped) || tail != head + capacity_ || getSlot(head).sequence.load(std::memory_order_acquire) != head + 1)
+        {
+            break; //The slot at 'tail_' is not the oldest full slot, it is not published yet or another producer took the next one.
+        }
+
+        if (!head_.compare_exchange_weak(head, head + 1, std::memory_order_relaxed))
+        {
+            continue;
+        }
+
+        //The sequence of the slot stays 'head + 1', which is not 'tail' with 2 slots at least, so no other producer can reserve it,
+        //and the other producers that drop items need 'head', so only this producer can advance 'tail_' past it.
+        Slot& slot = getSlot(head);
+        if (overflowPolicy_ == OverflowPolicy::DROP_OLDEST)
+        {
+            slot.item->empty();
+        }
+
+        tail_.store(tail + 1, std::memory_order_relaxed);
+
+        if (dropped == 0)
+        {
+            position = tail;
+        }
+        dropped++;
+        droppedItems_.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    return dropped;
+}
+
+bool RingBuffer::canDropOldest() const
+{
+    size_t position = head_.load(std::memory_order_relaxed);
+    return dropsOldest() && tail_.load(std::memory_order_relaxed) == position + capacity_ &&
+           getSlot(position).sequence.load(std::memory_order_acquire) == position + 1;
+}
+
+bool RingBuffer::canProduce() const
+{
+    size_t position = tail_.load(std::memory_order_relaxed);
+    return getSlot(position).sequence.load(std::memory_order_acquire) >= position;
+}
+
+bool RingBuffer::canConsume() const
+{
+    size_t position = head_.load(std::memory_order_relaxed);
+    return getSlot(position).sequence.load(std::memory_order_acquire) >= position + 1;
+}
+
+void RingBuffer::produce(const IBufferActor* producer)
+{
+    produceBatch(producer, 1);
+}
+
+size_t RingBuffer::produceBatch(const IBufferActor* producer, size_t count)
+{
+    return produceBatch(producer, count, ItemVisitor());
+}
+
+size_t RingBuffer::produceBatch(const IBufferActor* producer, size_t count, const ItemVisitor& fill)
+{
+    return produceBatchUntil(producer, count, fill, std::chrono::steady_clock::time_point::max());
+}
+
+size_t RingBuffer::produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return produceBatchUntil(producer, count, ItemVisitor(), deadline);
+}
+
+size_t RingBuffer::produceBatchUntil(const IBufferActor* producer, size_t count, const ItemVisitor& fill, const std::chrono::steady_clock::time_point& deadline)
+{
+    size_t position;
+    size_t reserved = reserveToProduce(position, count, false);
+    if (reserved == 0)
+    {
+        eventSink_->onBufferFull();
+        if (overflowPolicy_ == OverflowPolicy::REJECT)
+        {
+            return 0;
+        }
+
+        bool ready = wait(notFullCV_, notFullWaiters_, [this, producer](){
+            return canProduce() || canDropOldest() || quitSignal_ || IBufferActor::isStopped(producer);
+        }, deadline);
+
+        if (!ready || quitSignal_ || IBufferActor::isStopped(producer))
+        {
+            return 0;
+        }
+
+        reserved = reserveToProduce(position, count, false);
+        if (reserved == 0)
+        {
+            spuriousWakeups_.fetch_add(1, std::memory_order_relaxed); //Another producer reserved the released slot first.
+            return 0;
+        }
+    }
+
+    return publishProduced(position, reserved, fill);
+}
+
+size_t RingBuffer::tryProduceBatch(size_t count)
+{
+    return tryProduce(count, ItemVisitor(), false);
+}
+
+size_t RingBuffer::retryProduceBatch(size_t count)
+{
+    return tryProduce(count, ItemVisitor(), true);
+}
+
+size_t RingBuffer::tryProduceBatch(size_t count, const ItemVisitor& fill)
+{
+    return tryProduce(count, fill, false);
+}
+
+size_t RingBuffer::tryProduce(size_t count, const ItemVisitor& fill, bool retried)
+{
+    size_t position;
+    if (quitSignal_)
+    {
+        return 0;
+    }
+
+    size_t reserved = reserveToProduce(position, count, retried);
+    if (reserved == 0)
+    {
+        return 0;
+    }
+
+    return publishProduced(position, reserved, fill);
+}
+
+size_t RingBuffer::publishProduced(size_t position, size_t reserved, const ItemVisitor& fill)
+{
+    if (canProduce())
+    {
+        wakeWaiters(notFullCV_, notFullWaiters_, notFullRegisteredWaiters_, 1);
+    }
+
+    for(size_t i = 0; i < reserved; ++i)
+    {
+        Slot& slot = getSlot(position + i);
+        if (fill)
+        {
+            fill(*(slot.item));
+        }
+        else
+        {
+            slot.item->fill();
+        }
+        slot.sequence.store(position + i + 1, std::memory_order_release);
+    }
+    wakeWaiters(notEmptyCV_, notEmptyWaiters_, notEmptyRegisteredWaiters_, reserved);
+    if (dropsOldest())
+    {
+        wakeWaiters(notFullCV_, notFullWaiters_, notFullRegisteredWaiters_, reserved); //Producers waiting for the oldest item to be published can drop it now.
+    }
+    eventSink_->onProduced(reserved);
+    return reserved;
+}
+
+void RingBuffer::consume(const IBufferActor* consumer)
+{
+    consumeBatch(consumer, 1);
+}
+
+size_t RingBuffer::consumeBatch(const IBufferActor* consumer, size_t count)
+{
+    return consumeBatch(consumer, count, ItemVisitor());
+}
+
+size_t RingBuffer::consumeBatch(const IBufferActor* consumer, size_t count, const ItemVisitor& empty)
+{
+    return consumeBatchUntil(consumer, count, empty, std::chrono::steady_clock::time_point::max());
+}
+
+size_t RingBuffer::consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return consumeBatchUntil(consumer, count, ItemVisitor(), deadline);
+}
+
+size_t RingBuffer::consumeBatchUntil(const IBufferActor* consumer, size_t count, const ItemVisitor& empty, const std::chrono::steady_clock::time_point& deadline)
+{
+    size_t position;
+    size_t reserved = reserve(head_, singleConsumer_, consumerInSinglePath_, position, count, 1);
+    if (reserved == 0)
+    {
+        eventSink_->onBufferEmpty();
+        bool ready = wait(notEmptyCV_, notEmptyWaiters_, [this, consumer](){
+            return canConsume() || quitSignal_ || IBufferActor::isStopped(consumer);
+        }, deadline);
+
+        if (!ready || quitSignal_ || IBufferActor::isStopped(consumer))
+        {
+            return 0;
+        }
+
+        reserved = reserve(head_, singleConsumer_, consumerInSinglePath_, position, count, 1);
+        if (reserved == 0)
+        {
+            spuriousWakeups_.fetch_add(1, std::memory_order_relaxed); //Another consumer reserved the published slot first.
+            return 0;
+        }
+    }
+
+    return publishConsumed(position, reserved, empty);
+}
+
+size_t RingBuffer::tryConsumeBatch(size_t count)
+{
+    return tryConsumeBatch(count, ItemVisitor());
+}
+
+size_t RingBuffer::tryConsumeBatch(size_t count, const ItemVisitor& empty)
+{
+    size_t position;
+    size_t reserved = quitSignal_ ? 0 : reserve(head_, singleConsumer_, consumerInSinglePath_, position, count, 1);
+    if (reserved == 0)
+    {
+        return 0;
+    }
+
+    return publishConsumed(position, reserved, empty);
+}
+
+size_t RingBuffer::publishConsumed(size_t position, size_t reserved, const ItemVisitor& empty)
+{
+    if (canConsume())
+    {
+        wakeWaiters(notEmptyCV_, notEmptyWaiters_, notEmptyRegisteredWaiters_, 1);
+    }
+
+    for(size_t i = 0; i < reserved; ++i)
+    {
+        Slot& slot = getSlot(position + i);
+        if (empty)
+        {
+            empty(*(slot.item));
+        }
+        else
+        {
+            slot.item->empty();
+        }
+        slot.sequence.store(position + i + capacity_, std::memory_order_release);
+    }
+    wakeWaiters(notFullCV_, notFullWaiters_, notFullRegisteredWaiters_, reserved);
+    eventSink_->onConsumed(reserved);
+    return reserved;
+}
+
+bool RingBuffer::wait(std::condition_variable& conditionVariable, std::atomic<size_t>& waiters, const std::function<bool()>& ready,
+                      const std::chrono::steady_clock::time_point& deadline)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    bool parks = waitStrategy_->parksThreads(); //The spinning threads do not need to be woken up, so they are not counted.
+    if (parks)
+    {
+        waiters.fetch_add(1);
+    }
+    std::atomic_thread_fence(std::memory_order_seq_cst); //Pairs with the fence in 'wakeWaiters' so that either the waker sees this waiter or this waiter sees the published slot.
+    bool isReady = waitStrategy_->wait(lock, conditionVariable, ready, ready, deadline, &parkedSpuriousWakeups_); //'ready' only reads atomics.
+    if (parks)
+    {
+        waiters.fetch_sub(1);
+    }
+    return isReady;
+}
+
+void RingBuffer::wakeWaiters(std::condition_variable& conditionVariable, std::atomic<size_t>& waiters, std::deque<std::function<void()>>& registeredWaiters,
+                             size_t items)
+{
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (waiters.load(std::memory_order_relaxed) == 0)
+    {
+        return;
+    }
+
+    std::scoped_lock lock(mutex_);
+    for(size_t i = 0; i < items && !registeredWaiters.empty(); ++i)
+    {
+        registeredWaiters.front()();
+        registeredWaiters.pop_front();
+        waiters.fetch_sub(1);
+    }
+
+    size_t sleepingThreads = waiters.load() - registeredWaiters.size();
+    if (sleepingThreads == 0)
+    {
+        return;
+    }
+
+    if (items >= sleepingThreads)
+    {
+        conditionVariable.notify_all();
+        return;
+    }
+
+    for(size_t i = 0; i < items; ++i)
+    {
+        conditionVariable.notify_one();
+    }
+}
+
+bool RingBuffer::addWaiter(ActorRole role, const std::function<void()>& waiter)
+{
+    bool producer = role == ActorRole::PRODUCER;
+    std::atomic<size_t>& waiters = producer ? notFullWaiters_ : notEmptyWaiters_;
+    std::scoped_lock lock(mutex_);
+    if (quitSignal_)
+    {
+        return false;
+    }
+
+    waiters.fetch_add(1);
+    std::atomic_thread_fence(std::memory_order_seq_cst); //Pairs with the fence in 'wakeWaiters', as in 'wait'.
+    if (producer ? canProduce() || canDropOldest() : canConsume())
+    {
+        waiters.fetch_sub(1);
+        return false;
+    }
+
+    (producer ? notFullRegisteredWaiters_ : notEmptyRegisteredWaiters_).push_back(waiter);
+    return true;
+}
+
+bool RingBuffer::isReady(ActorRole role) const
+{
+    if (quitSignal_)
+    {
+        return false;
+    }
+
+    return role == ActorRole::PRODUCER ? canProduce() || canDropOldest() : canConsume();
+}
+
+void RingBuffer::callRegisteredWaiters()
+{
+    for(auto* registeredWaiters: {&notFullRegisteredWaiters_, &notEmptyRegisteredWaiters_})
+    {
+        std::atomic<size_t>& waiters = registeredWaiters == &notFullRegisteredWaiters_ ? notFullWaiters_ : notEmptyWaiters_;
+        for(auto& waiter: *registeredWaiters)
+        {
+            waiter();
+        }
+        waiters.fetch_sub(registeredWaiters->size());
+        registeredWaiters->clear();
+    }
+}
+
+void RingBuffer::stop()
+{
+    std::scoped_lock lock(mutex_);
+    quitSignal_ = true;
+    notFullCV_.notify_all();
+    notEmptyCV_.notify_all();
+    callRegisteredWaiters();
+}
+
+void RingBuffer::notify()
+{
+    std::scoped_lock lock(mutex_);
+    notFullCV_.notify_all();
+    notEmptyCV_.notify_all();
+    callRegisteredWaiters();
+}
+
+bool RingBuffer::isRunning() const
+{
+    return !quitSignal_;
+}
+
+size_t RingBuffer::getCurrentIndex() const
+{
+    size_t head = head_.load(std::memory_order_acquire);
+    return tail_.load(std::memory_order_acquire) - head;
+}
+
+BufferStatistics RingBuffer::getStatistics() const
+{
+    std::scoped_lock lock(mutex_);
+    BufferStatistics statistics;
+    statistics.spuriousWakeups = spuriousWakeups_.load(std::memory_order_relaxed) + parkedSpuriousWakeups_;
+    statistics.droppedItems = droppedItems_.load(std::memory_order_relaxed);
+    return statistics;
+}
+
+IWaitStrategy& RingBuffer::getWaitStrategy()
+{
+    return *waitStrategy_;
+}
\ No newline at end of file
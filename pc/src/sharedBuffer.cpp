@@ -1,78 +1,214 @@
-#include <iostream>
+#include <algorithm>
 #include "sharedBuffer.h"
-#include "producer.h"
-#include "consumer.h"
+#include "IActor.h"
 
-SharedBuffer::SharedBuffer(const IPC::ItemsBuffer& buffer)
-: currentIndex_(0)
-, buffer_(buffer)
-, quitSignal_(false)
+SharedBuffer::ConditionVariable::ConditionVariable(IWaitStrategy& waitStrategy)
+: waitStrategy_(waitStrategy)
 {
-    calculateCurrentIndex();
+}
+
+bool SharedBuffer::ConditionVariable::wait(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, const std::function<bool()>& probe,
+                                           const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups)
+{
+    return waitStrategy_.wait(lock, conditionVariable_, ready, probe, deadline, spuriousWakeups);
+}
+
+void SharedBuffer::ConditionVariable::notifyOne()
+{
+    conditionVariable_.notify_one();
+}
+
+void SharedBuffer::ConditionVariable::notifyAll()
+{
+    conditionVariable_.notify_all();
+}
+
+bool SharedBuffer::ConditionVariable::parksThreads() const
+{
+    return waitStrategy_.parksThreads();
+}
+
+SharedBuffer::SharedBuffer(size_t size, const BufferOptions& options)
+: size_(size)
+, eventSink_(options.eventSink ? options.eventSink : &nullEventSink_)
+, waitStrategy_(IWaitStrategy::create(options.waitStrategy))
+, indices_{0, 0, 0, 0}
+, slots_(size, Slot{SlotState::EMPTY})
+, notFullCV_(*waitStrategy_)
+, notEmptyCV_(*waitStrategy_)
+, queue_(options.overflowPolicy, *eventSink_)
+{
+    queue_.attach(mutex_, notFullCV_, notEmptyCV_, slots_.data(), indices_, size_, queue_.getOrdering(options.ordering, options.overflowPolicy), Slot());
 }
 
 void SharedBuffer::calculateCurrentIndex()
 {
-    for(currentIndex_ = 0; (currentIndex_ < buffer_.size() && *(buffer_[currentIndex_])); currentIndex_++);
+    for(indices_.currentIndex = 0; (indices_.currentIndex < size_ && isItemFilled(indices_.currentIndex)); indices_.currentIndex++);
+
+    std::fill(slots_.begin(), slots_.end(), Slot{SlotState::EMPTY});
+    std::fill(slots_.begin(), slots_.begin() + indices_.currentIndex, Slot{SlotState::FULL});
 }
 
-void SharedBuffer::produce(const Producer* producer)
+size_t SharedBuffer::getSlot(size_t first, size_t offset) const
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (currentIndex_ < buffer_.size())
-    {
-        buffer_[currentIndex_++]->fill();
-        std::cout << "Pushing value" << std::endl;
-        quitCV_.notify_all();
-    }
-    else
-    {
-        std::cout << "Buffer full. Waiting for someone to consume." << std::endl;
-        quitCV_.wait(lock, [this, producer](){
-            return currentIndex_ < buffer_.size() || quitSignal_ || !producer->isRunning();
-        });
-    }
+    return queue_.getSlot(first, offset);
 }
 
-void SharedBuffer::consume(const Consumer* consumer)
+void SharedBuffer::fillSlots(size_t first, size_t count, const ItemVisitor& fill)
 {
-    std::unique_lock<std::mutex> lock(mutex_);
-    if (currentIndex_ > 0)
+    if (!fill)
     {
-        buffer_[--currentIndex_]->empty();
-        std::cout << "Poping value" << std::endl;
-        quitCV_.notify_all();
+        fillItems(first, count);
+        return;
     }
-    else
+
+    visitItems(first, count, fill);
+}
+
+void SharedBuffer::emptySlots(size_t first, size_t count, const ItemVisitor& empty)
+{
+    if (!empty)
     {
-        std::cout << "Buffer empty. Waiting for someone to push." << std::endl;
-        quitCV_.wait(lock, [this, consumer](){
-            return (currentIndex_ > 0) || quitSignal_ || !consumer->isRunning();
-        });
+        emptyItems(first, count);
+        return;
     }
+
+    visitItems(first, count, empty);
+}
+
+void SharedBuffer::produce(const IBufferActor* producer)
+{
+    produceBatch(producer, 1);
+}
+
+size_t SharedBuffer::produceBatch(const IBufferActor* producer, size_t count)
+{
+    return produceBatch(producer, count, ItemVisitor());
+}
+
+size_t SharedBuffer::produceBatch(const IBufferActor* producer, size_t count, const ItemVisitor& fill)
+{
+    return produceBatchUntil(producer, count, fill, std::chrono::steady_clock::time_point::max());
+}
+
+size_t SharedBuffer::produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return produceBatchUntil(producer, count, ItemVisitor(), deadline);
+}
+
+size_t SharedBuffer::produceBatchUntil(const IBufferActor* producer, size_t count, const ItemVisitor& fill, const std::chrono::steady_clock::time_point& deadline)
+{
+    return queue_.produce(producer, count, deadline, [this, &fill](size_t first, size_t reserved){
+        fillSlots(first, reserved, fill);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    });
+}
+
+size_t SharedBuffer::tryProduceBatch(size_t count)
+{
+    return queue_.tryProduce(count, [this](size_t first, size_t reserved){
+        fillItems(first, reserved);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    }, false);
+}
+
+size_t SharedBuffer::retryProduceBatch(size_t count)
+{
+    return queue_.tryProduce(count, [this](size_t first, size_t reserved){
+        fillItems(first, reserved);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    }, true);
+}
+
+size_t SharedBuffer::tryProduceBatch(size_t count, const ItemVisitor& fill)
+{
+    return queue_.tryProduce(count, [this, &fill](size_t first, size_t reserved){
+        fillSlots(first, reserved, fill);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    }, false);
+}
+
+void SharedBuffer::consume(const IBufferActor* consumer)
+{
+    consumeBatch(consumer, 1);
+}
+
+size_t SharedBuffer::consumeBatch(const IBufferActor* consumer, size_t count)
+{
+    return consumeBatch(consumer, count, ItemVisitor());
+}
+
+size_t SharedBuffer::consumeBatch(const IBufferActor* consumer, size_t count, const ItemVisitor& empty)
+{
+    return consumeBatchUntil(consumer, count, empty, std::chrono::steady_clock::time_point::max());
+}
+
+size_t SharedBuffer::consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return consumeBatchUntil(consumer, count, ItemVisitor(), deadline);
+}
+
+size_t SharedBuffer::consumeBatchUntil(const IBufferActor* consumer, size_t count, const ItemVisitor& empty, const std::chrono::steady_clock::time_point& deadline)
+{
+    return queue_.consume(consumer, count, deadline, [this, &empty](size_t first, size_t reserved){
+        emptySlots(first, reserved, empty);
+    });
+}
+
+size_t SharedBuffer::tryConsumeBatch(size_t count)
+{
+    return queue_.tryConsume(count, [this](size_t first, size_t reserved){
+        emptyItems(first, reserved);
+    });
+}
+
+size_t SharedBuffer::tryConsumeBatch(size_t count, const ItemVisitor& empty)
+{
+    return queue_.tryConsume(count, [this, &empty](size_t first, size_t reserved){
+        emptySlots(first, reserved, empty);
+    });
+}
+
+bool SharedBuffer::addWaiter(ActorRole role, const std::function<void()>& waiter)
+{
+    return queue_.addWaiter(role, waiter);
+}
+
+bool SharedBuffer::isReady(ActorRole role) const
+{
+    return queue_.isReady(role);
 }
 
 void SharedBuffer::stop()
 {
-    std::scoped_lock lock(mutex_);
-    quitSignal_ = true;
-    quitCV_.notify_all(); //If the signaling is performed without locking, Helgrind complains that the lock associated with 'quitSignal' is not held by any thread.
+    queue_.stop();
 }
 
 void SharedBuffer::notify()
 {
-    std::scoped_lock lock(mutex_);
-    quitCV_.notify_all();
+    queue_.notify();
 }
 
 bool SharedBuffer::isRunning() const
 {
-    std::scoped_lock lock(mutex_);
-    return !quitSignal_;
+    return queue_.isRunning();
 }
 
 size_t SharedBuffer::getCurrentIndex() const
 {
-    std::scoped_lock lock(mutex_);
-    return currentIndex_;
-}
\ No newline at end of file
+    return queue_.getCurrentIndex();
+}
+
+BufferStatistics SharedBuffer::getStatistics() const
+{
+    return queue_.getStatistics();
+}
+
+IWaitStrategy& SharedBuffer::getWaitStrategy()
+{
+    return *waitStrategy_;
+}
@@ -0,0 +1,681 @@
+#include <algorithm>
+#include <cerrno>
+#include <cinttypes>
+#include <cstdio>
+#include <cstring>
+#include <ctime>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "sharedMemoryBuffer.h"
+#include "IActor.h"
+#include "executor.h"
+
+constexpr std::chrono::milliseconds SharedMemoryBuffer::RECOVERY_INTERVAL;
+constexpr size_t SharedMemoryBuffer::MAX_OWNERS;
+
+SharedMemoryBuffer::SegmentMutex::SegmentMutex(SharedMemoryBuffer& buffer)
+: buffer_(buffer)
+{
+}
+
+void SharedMemoryBuffer::SegmentMutex::lock()
+{
+    if (pthread_mutex_lock(&buffer_.header_->mutex) == EOWNERDEAD)
+    {
+        buffer_.recoverSlots();
+        pthread_mutex_consistent(&buffer_.header_->mutex);
+    }
+}
+
+void SharedMemoryBuffer::SegmentMutex::unlock()
+{
+    pthread_mutex_unlock(&buffer_.header_->mutex);
+}
+
+SharedMemoryBuffer::SegmentConditionVariable::SegmentConditionVariable(SharedMemoryBuffer& buffer, pthread_cond_t Header::* conditionVariable)
+: buffer_(buffer)
+, conditionVariable_(conditionVariable)
+{
+}
+
+bool SharedMemoryBuffer::SegmentConditionVariable::wait(std::unique_lock<SegmentMutex>& lock, const std::function<bool()>& ready,
+                                                        const std::function<bool()>& /*probe*/, const std::chrono::steady_clock::time_point& deadline,
+                                                        size_t* spuriousWakeups)
+{
+    Header* header = buffer_.header_;
+    while(!ready())
+    {
+        //The steady clock is 'CLOCK_MONOTONIC', with which the condition variables of the segment are created.
+        std::chrono::steady_clock::time_point now = std::chrono::steady_clock::now();
+        if (now >= deadline)
+        {
+            break;
+        }
+
+        std::chrono::nanoseconds wakeUp = (now + std::min(deadline - now, std::chrono::steady_clock::duration(RECOVERY_INTERVAL))).time_since_epoch();
+        timespec wakeUpTime;
+        wakeUpTime.tv_sec = std::chrono::duration_cast<std::chrono::seconds>(wakeUp).count();
+        wakeUpTime.tv_nsec = (wakeUp - std::chrono::seconds(wakeUpTime.tv_sec)).count();
+
+        int result = pthread_cond_timedwait(&(header->*conditionVariable_), &header->mutex, &wakeUpTime);
+        if (result == EOWNERDEAD)
+        {
+            buffer_.recoverSlots();
+            pthread_mutex_consistent(&header->mutex);
+        }
+        else if (result == ETIMEDOUT && buffer_.isRecoveryDue())
+        {
+            buffer_.recoverSlots(lock);
+        }
+        else if (!ready() && spuriousWakeups)
+        {
+            (*spuriousWakeups)++;
+        }
+    }
+
+    return ready();
+}
+
+void SharedMemoryBuffer::SegmentConditionVariable::notifyOne()
+{
+    pthread_cond_signal(&(buffer_.header_->*conditionVariable_));
+}
+
+void SharedMemoryBuffer::SegmentConditionVariable::notifyAll()
+{
+    pthread_cond_broadcast(&(buffer_.header_->*conditionVariable_)); //The actors of the other processes wake up too, and go back to sleep.
+}
+
+bool SharedMemoryBuffer::SegmentConditionVariable::parksThreads() const
+{
+    return true;
+}
+
+SharedMemoryBuffer::SharedMemoryBuffer(const BufferOptions& options)
+: eventSink_(options.eventSink ? options.eventSink : &nullEventSink_)
+, waitStrategy_(IWaitStrategy::create(options.waitStrategy))
+, ordering_(options.ordering)
+, overflowPolicy_(options.overflowPolicy)
+, self_(readSelf())
+, ownerIndex_(MAX_OWNERS)
+, lastRecovery_(std::chrono::steady_clock::now().time_since_epoch().count())
+, owner_(false)
+, segmentSize_(0)
+, header_(nullptr)
+, mutex_(*this)
+, notFullCV_(*this, &Header::notFullCV)
+, notEmptyCV_(*this, &Header::notEmptyCV)
+, queue_(options.overflowPolicy, *eventSink_)
+, waiterTimer_(new WaiterTimer{this, false, {}})
+{
+}
+
+SharedMemoryBuffer::~SharedMemoryBuffer()
+{
+    {
+        std::scoped_lock lock(waiterTimer_->mutex);
+        waiterTimer_->buffer = nullptr;
+    }
+
+    if (ownerIndex_ < MAX_OWNERS)
+    {
+        std::scoped_lock lock(mutex_);
+        header_->owners[ownerIndex_].pid = 0;
+    }
+
+    if (header_)
+    {
+        munmap(header_, segmentSize_);
+    }
+
+    if (owner_)
+    {
+        shm_unlink(name_.c_str());
+    }
+}
+
+bool SharedMemoryBuffer::createSegment(const std::string& name, size_t size, size_t itemSize)
+{
+    if (size == 0 || !isOverflowPolicySupported())
+    {
+        return false;
+    }
+
+    int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    name_ = name;
+    owner_ = true;
+
+    size_t itemsOffset = sizeof(Header) + size * sizeof(Slot);
+    itemsOffset = (itemsOffset + 63) / 64 * 64; //The items start on their own cache line.
+    segmentSize_ = itemsOffset + size * itemSize;
+    if (ftruncate(fd, segmentSize_) != 0 || !mapSegment(fd))
+    {
+        close(fd);
+        return false;
+    }
+    close(fd);
+
+    new (header_) Header();
+    header_->size = size;
+    header_->itemSize = itemSize;
+    header_->itemsOffset = itemsOffset;
+    header_->ordering = ordering_;
+    header_->indices = SlotIndices{0, 0, 0, 0};
+    header_->recoveredSlots = 0;
+
+    pthread_mutexattr_t mutexAttributes;
+    pthread_mutexattr_init(&mutexAttributes);
+    pthread_mutexattr_setpshared(&mutexAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_mutexattr_setrobust(&mutexAttributes, PTHREAD_MUTEX_ROBUST);
+    pthread_mutex_init(&header_->mutex, &mutexAttributes);
+    pthread_mutexattr_destroy(&mutexAttributes);
+
+    pthread_condattr_t conditionAttributes;
+    pthread_condattr_init(&conditionAttributes);
+    pthread_condattr_setpshared(&conditionAttributes, PTHREAD_PROCESS_SHARED);
+    pthread_condattr_setclock(&conditionAttributes, CLOCK_MONOTONIC);
+    pthread_cond_init(&header_->notFullCV, &conditionAttributes);
+    pthread_cond_init(&header_->notEmptyCV, &conditionAttributes);
+    pthread_condattr_destroy(&conditionAttributes);
+
+    std::fill(getSlots(), getSlots() + size, Slot{SlotState::EMPTY, 0});
+    header_->owners[0] = self_;
+    ownerIndex_ = 0;
+    attachQueue();
+    return true;
+}
+
+bool SharedMemoryBuffer::isOverflowPolicySupported() const
+{
+    //The ordering is chosen by the process that creates the segment, and only a FIFO buffer keeps its oldest item at the head.
+    return overflowPolicy_ == OverflowPolicy::BLOCK || overflowPolicy_ == OverflowPolicy::REJECT;
+}
+
+void SharedMemoryBuffer::publishSegment()
+{
+    header_->magic.store(MAGIC, std::memory_order_release);
+}
+
+bool SharedMemoryBuffer::attachSegment(const std::string& name, size_t itemSize)
+{
+    if (!isOverflowPolicySupported())
+    {
+        return false;
+    }
+
+    int fd = shm_open(name.c_str(), O_RDWR, 0600);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    struct stat status;
+    if (fstat(fd, &status) != 0 || static_cast<size_t>(status.st_size) < sizeof(Header))
+    {
+        close(fd);
+        return false;
+    }
+
+    name_ = name;
+    segmentSize_ = status.st_size;
+    bool mapped = mapSegment(fd);
+    close(fd);
+
+    if (!mapped || !isSegmentValid(itemSize))
+    {
+        return false;
+    }
+
+    {
+        std::scoped_lock lock(mutex_);
+        if (!registerOwner())
+        {
+            return false;
+        }
+    }
+
+    attachQueue();
+    return true;
+}
+
+bool SharedMemoryBuffer::isSegmentValid(size_t itemSize) const
+{
+    if (header_->magic.load(std::memory_order_acquire) != MAGIC || header_->itemSize != itemSize || header_->size == 0)
+    {
+        return false;
+    }
+
+    //The sizes were written by another process, so they are checked with divisions, which cannot overflow as the products could.
+    size_t itemsOffset = header_->itemsOffset;
+    return itemsOffset >= sizeof(Header) && itemsOffset <= segmentSize_ && (itemsOffset - sizeof(Header)) / sizeof(Slot) >= header_->size &&
+           (segmentSize_ - itemsOffset) / itemSize >= header_->size;
+}
+
+void SharedMemoryBuffer::attachQueue()
+{
+    queue_.attach(mutex_, notFullCV_, notEmptyCV_, getSlots(), header_->indices, header_->size, header_->ordering, Slot{SlotState::EMPTY, static_cast<uint32_t>(ownerIndex_)});
+}
+
+bool SharedMemoryBuffer::mapSegment(int fd)
+{
+    void* segment = mmap(nullptr, segmentSize_, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (segment == MAP_FAILED)
+    {
+        return false;
+    }
+
+    header_ = static_cast<Header*>(segment);
+    return true;
+}
+
+void* SharedMemoryBuffer::getItems() const
+{
+    return reinterpret_cast<char*>(header_) + header_->itemsOffset;
+}
+
+size_t SharedMemoryBuffer::getSize() const
+{
+    return header_->size;
+}
+
+SharedMemoryBuffer::Slot* SharedMemoryBuffer::getSlots() const
+{
+    return reinterpret_cast<Slot*>(header_ + 1);
+}
+
+bool SharedMemoryBuffer::readStartTime(pid_t pid, uint64_t& startTime)
+{
+    std::string path = "/proc/" + std::to_string(pid) + "/stat";
+    int fd = open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+    {
+        return false;
+    }
+
+    char content[1024];
+    ssize_t length = read(fd, content, sizeof(content) - 1);
+    close(fd);
+    if (length <= 0)
+    {
+        return false;
+    }
+    content[length] = '\0';
+
+    //The second field is the name of the process in parentheses, which can contain spaces and parentheses, so the fields are counted from
+    //the last ')'. The third field is the state, and the 22nd one is the start time.
+    const char* field = strrchr(content, ')');
+    if (!field || field[1] != ' ' || field[2] == 'Z' || field[2] == 'X')
+    {
+        return false;
+    }
+
+    for(size_t i = 2; i < 22 && field; ++i)
+    {
+        field = strchr(field + 1, ' ');
+    }
+
+    return field && sscanf(field, " %" SCNu64, &startTime) == 1;
+}
+
+uint64_t SharedMemoryBuffer::readPidNamespace()
+{
+    struct stat status;
+    return stat("/proc/self/ns/pid", &status) == 0 ? status.st_ino : 0;
+}
+
+SharedMemoryBuffer::Owner SharedMemoryBuffer::readSelf()
+{
+    Owner self{getpid(), 0, 0};
+    if (readStartTime(self.pid, self.startTime))
+    {
+        self.pidNamespace = readPidNamespace();
+    }
+
+    return self;
+}
+
+bool SharedMemoryBuffer::registerOwner()
+{
+    for(size_t tries = 0; tries < 2; ++tries)
+    {
+        Owner* owner = std::find_if(header_->owners, header_->owners + MAX_OWNERS, [](const Owner& owner){
+            return owner.pid == 0;
+        });
+
+        if (owner != header_->owners + MAX_OWNERS)
+        {
+            *owner = self_;
+            ownerIndex_ = owner - header_->owners;
+            return true;
+        }
+
+        recoverSlots();
+    }
+
+    return false;
+}
+
+bool SharedMemoryBuffer::isAlive(const Owner& owner) const
+{
+    if (owner.pidNamespace == 0 || owner.pidNamespace != self_.pidNamespace)
+    {
+        return true;
+    }
+
+    uint64_t startTime;
+    return readStartTime(owner.pid, startTime) && startTime == owner.startTime;
+}
+
+bool SharedMemoryBuffer::isRecoveryDue()
+{
+    std::chrono::steady_clock::rep now = std::chrono::steady_clock::now().time_since_epoch().count();
+    std::chrono::steady_clock::rep last = lastRecovery_.load(std::memory_order_relaxed);
+    return now - last >= std::chrono::steady_clock::duration(RECOVERY_INTERVAL).count() &&
+           lastRecovery_.compare_exchange_strong(last, now, std::memory_order_relaxed);
+}
+
+void SharedMemoryBuffer::recoverSlots()
+{
+    DeadOwners dead{};
+    for(size_t i = 0; i < MAX_OWNERS; ++i)
+    {
+        dead[i] = header_->owners[i].pid != 0 && !isAlive(header_->owners[i]);
+    }
+
+    reclaimSlots(header_->owners, dead);
+}
+
+void SharedMemoryBuffer::recoverSlots(std::unique_lock<SegmentMutex>& lock)
+{
+    //The records are checked on a copy, since reading /proc while holding the mutex would stall the actors of all the processes.
+    Owner owners[MAX_OWNERS];
+    std::copy(header_->owners, header_->owners + MAX_OWNERS, owners);
+    lock.unlock();
+
+    DeadOwners dead{};
+    bool anyDead = false;
+    for(size_t i = 0; i < MAX_OWNERS; ++i)
+    {
+        dead[i] = owners[i].pid != 0 && !isAlive(owners[i]);
+        anyDead = anyDead || dead[i];
+    }
+
+    lock.lock();
+    if (anyDead)
+    {
+        reclaimSlots(owners, dead);
+    }
+}
+
+void SharedMemoryBuffer::reclaimSlots(const Owner* owners, const DeadOwners& dead)
+{
+    //A record that changed since the copy was taken was freed and then taken by another process.
+    DeadOwners reclaimed{};
+    bool anyReclaimed = false;
+    for(size_t i = 0; i < MAX_OWNERS; ++i)
+    {
+        const Owner& owner = header_->owners[i];
+        reclaimed[i] = dead[i] && owner.pid == owners[i].pid && owner.startTime == owners[i].startTime;
+        anyReclaimed = anyReclaimed || reclaimed[i];
+    }
+
+    if (!anyReclaimed)
+    {
+        return;
+    }
+
+    size_t recovered = 0;
+    for(size_t i = 0; i < header_->size; ++i)
+    {
+        Slot& slot = getSlots()[i];
+        if ((slot.state != SlotState::FILLING && slot.state != SlotState::EMPTYING) || slot.owner >= MAX_OWNERS || !reclaimed[slot.owner])
+        {
+            continue;
+        }
+
+        //The item is reset in both cases, since the dead process may have left it half written.
+        resetItem(i);
+        slot.state = slot.state == SlotState::FILLING ? SlotState::ABANDONED : SlotState::EMPTY;
+        recovered++;
+    }
+
+    for(size_t i = 0; i < MAX_OWNERS; ++i)
+    {
+        if (reclaimed[i])
+        {
+            header_->owners[i].pid = 0;
+        }
+    }
+
+    if (recovered > 0)
+    {
+        header_->recoveredSlots += recovered;
+        notFullCV_.notifyAll();
+        notEmptyCV_.notifyAll();
+    }
+}
+
+void SharedMemoryBuffer::produce(const IBufferActor* producer)
+{
+    produceBatch(producer, 1);
+}
+
+size_t SharedMemoryBuffer::produceBatch(const IBufferActor* producer, size_t count)
+{
+    return produceBatchUntil(producer, count, std::chrono::steady_clock::time_point::max());
+}
+
+size_t SharedMemoryBuffer::produceBatchUntil(const IBufferActor* producer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return queue_.produce(producer, count, deadline, [this](size_t first, size_t reserved){
+        fillItems(first, reserved);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    });
+}
+
+size_t SharedMemoryBuffer::tryProduceBatch(size_t count)
+{
+    return tryProduce(count, false);
+}
+
+size_t SharedMemoryBuffer::retryProduceBatch(size_t count)
+{
+    return tryProduce(count, true);
+}
+
+size_t SharedMemoryBuffer::tryProduce(size_t count, bool retried)
+{
+    size_t produced = queue_.tryProduce(count, [this](size_t first, size_t reserved){
+        fillItems(first, reserved);
+    }, [this](size_t first, size_t dropped){
+        emptyItems(first, dropped);
+    }, retried);
+
+    //The actors that never wait, like the pooled ones, look for dead owners too, or a dead producer could keep them failing forever.
+    if (produced == 0 && isRecoveryDue())
+    {
+        std::unique_lock lock(mutex_);
+        recoverSlots(lock);
+    }
+
+    return produced;
+}
+
+void SharedMemoryBuffer::consume(const IBufferActor* consumer)
+{
+    consumeBatch(consumer, 1);
+}
+
+size_t SharedMemoryBuffer::consumeBatch(const IBufferActor* consumer, size_t count)
+{
+    return consumeBatchUntil(consumer, count, std::chrono::steady_clock::time_point::max());
+}
+
+size_t SharedMemoryBuffer::consumeBatchUntil(const IBufferActor* consumer, size_t count, const std::chrono::steady_clock::time_point& deadline)
+{
+    return queue_.consume(consumer, count, deadline, [this](size_t first, size_t reserved){
+        emptyItems(first, reserved);
+    });
+}
+
+size_t SharedMemoryBuffer::tryConsumeBatch(size_t count)
+{
+    size_t consumed = queue_.tryConsume(count, [this](size_t first, size_t reserved){
+        emptyItems(first, reserved);
+    });
+
+    if (consumed == 0 && isRecoveryDue())
+    {
+        std::unique_lock lock(mutex_);
+        recoverSlots(lock);
+    }
+
+    return consumed;
+}
+
+bool SharedMemoryBuffer::addWaiter(ActorRole role, const std::function<void()>& waiter)
+{
+    if (!queue_.addWaiter(role, waiter))
+    {
+        return false;
+    }
+
+    scheduleWaiterTimer();
+    return true;
+}
+
+void SharedMemoryBuffer::scheduleWaiterTimer()
+{
+    std::scoped_lock lock(waiterTimer_->mutex);
+    if (waiterTimer_->scheduled)
+    {
+        return;
+    }
+
+    waiterTimer_->scheduled = true;
+    std::shared_ptr<WaiterTimer> waiterTimer = waiterTimer_;
+    Executor::getDefault().schedule([waiterTimer](){
+        std::scoped_lock lock(waiterTimer->mutex);
+        waiterTimer->scheduled = false;
+        if (waiterTimer->buffer)
+        {
+            //The waiters that find the buffer still full or empty register again, which schedules this task again.
+            std::scoped_lock bufferLock(waiterTimer->buffer->mutex_);
+            waiterTimer->buffer->queue_.callWaiters();
+        }
+    }, std::chrono::steady_clock::now() + RECOVERY_INTERVAL);
+}
+
+void SharedMemoryBuffer::stop()
+{
+    queue_.stop();
+}
+
+void SharedMemoryBuffer::notify()
+{
+    queue_.notify();
+}
+
+bool SharedMemoryBuffer::isRunning() const
+{
+    return queue_.isRunning();
+}
+
+size_t SharedMemoryBuffer::getCurrentIndex() const
+{
+    return queue_.getCurrentIndex();
+}
+
+BufferStatistics SharedMemoryBuffer::getStatistics() const
+{
+    BufferStatistics statistics = queue_.getStatistics();
+    std::scoped_lock lock(mutex_);
+    statistics.recoveredSlots = header_->recoveredSlots;
+    return statistics;
+}
+
+IWaitStrategy& SharedMemoryBuffer::getWaitStrategy()
+{
+    return *waitStrategy_;
+}
+
+std::unique_ptr<InlineSharedMemoryBuffer> InlineSharedMemoryBuffer::create(const std::string& name, size_t size, std::unique_ptr<IInlineItems> operations,
+                                                                          const BufferOptions& options)
+{
+    size_t itemSize = operations->getItemSize();
+    std::unique_ptr<InlineSharedMemoryBuffer> buffer(new InlineSharedMemoryBuffer(std::move(operations), options));
+    if (!buffer->createSegment(name, size, itemSize))
+    {
+        return nullptr;
+    }
+
+    buffer->operations_->reset(buffer->getItem(0), size);
+    buffer->publishSegment();
+    return buffer;
+}
+
+std::unique_ptr<InlineSharedMemoryBuffer> InlineSharedMemoryBuffer::attach(const std::string& name, std::unique_ptr<IInlineItems> operations,
+                                                                          const BufferOptions& options)
+{
+    size_t itemSize = operations->getItemSize();
+    std::unique_ptr<InlineSharedMemoryBuffer> buffer(new InlineSharedMemoryBuffer(std::move(operations), options));
+    if (!buffer->attachSegment(name, itemSize))
+    {
+        return nullptr;
+    }
+
+    return buffer;
+}
+
+InlineSharedMemoryBuffer::InlineSharedMemoryBuffer(std::unique_ptr<IInlineItems> operations, const BufferOptions& options)
+: SharedMemoryBuffer(options)
+, operations_(std::move(operations))
+{
+}
+
+void InlineSharedMemoryBuffer::fillItems(size_t first, size_t count)
+{
+    forEachRange(first, count, [this](void* items, size_t rangeCount){
+        operations_->fill(items, rangeCount);
+    });
+}
+
+void InlineSharedMemoryBuffer::emptyItems(size_t first, size_t count)
+{
+    forEachRange(first, count, [this](void* items, size_t rangeCount){
+        operations_->empty(items, rangeCount);
+    });
+}
+
+void InlineSharedMemoryBuffer::resetItem(size_t index)
+{
+    operations_->reset(getItem(index), 1);
+}
+
+void* InlineSharedMemoryBuffer::getItem(size_t index) const
+{
+    return static_cast<char*>(getItems()) + index * operations_->getItemSize();
+}
+
+template <class Function>
+void InlineSharedMemoryBuffer::forEachRange(size_t first, size_t count, Function function) const
+{
+    size_t firstRange = std::min(count, getSize() - first);
+    if (firstRange > 0)
+    {
+        function(getItem(first), firstRange);
+    }
+
+    if (count > firstRange)
+    {
+        function(getItem(0), count - firstRange);
+    }
+}
@@ -0,0 +1,127 @@
+#include <thread>
+#include "stageWorker.h"
+
+PipelineStage::PipelineStage(IItemsBuffer* _input, IItemsBuffer* _output, bool _outputRejects, const Transform& _transform)
+: input(_input)
+, output(_output)
+, outputRejects(_outputRejects)
+, transform(_transform)
+, droppedItems(0)
+{}
+
+size_t PipelineStage::moveItems(size_t count, ActorRole& waitingRole)
+{
+    IItemsBuffer::ItemVisitor move = [this](IBufferItem& item){
+        this->move(item);
+    };
+
+    size_t moved = 0;
+    for(; moved < count; ++moved)
+    {
+        if (!outputRejects && !output->isReady(ActorRole::PRODUCER))
+        {
+            waitingRole = ActorRole::PRODUCER;
+            break;
+        }
+
+        if (input->tryConsumeBatch(1, move) == 0)
+        {
+            waitingRole = ActorRole::CONSUMER;
+            break;
+        }
+    }
+
+    return moved;
+}
+
+void PipelineStage::move(IBufferItem& item)
+{
+    IItemsBuffer::ItemVisitor fill = [this, &item](IBufferItem& outputItem){
+        transform(item, outputItem);
+    };
+
+    //No other producer can take the room found by 'moveItems'. Only a consumer that reserved the slot meanwhile, the top of a 'LIFO' buffer or
+    //the oldest item that a 'DROP_OLDEST' buffer would drop, makes the try fail, and it releases the slot once its item is emptied, without
+    //waiting for room anywhere, so the retries never wait for other items to be produced or consumed.
+    while(output->tryProduceBatch(1, fill) == 0)
+    {
+        if (outputRejects || !output->isRunning())
+        {
+            item.empty();
+            droppedItems.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+
+        std::this_thread::yield();
+    }
+}
+
+StageWorker::StageWorker(PipelineStage& stage)
+: IBufferActor(stage.input)
+, stage_(stage)
+, wakeup_(new Wakeup{false, {}, {}})
+{}
+
+void StageWorker::requestStop()
+{
+    IBufferActor::requestStop();
+
+    //The mutex is taken so the worker does not miss the notification between checking the quit signal and waiting.
+    {
+        std::scoped_lock lock(wakeup_->mutex);
+    }
+    wakeup_->readyCV.notify_all();
+}
+
+void StageWorker::run(const ActorOptions& options)
+{
+    size_t moved = 0;
+    while(stage_.input->isRunning() && stage_.output->isRunning() && rest(moved))
+    {
+        moved = moveItems(options.batchSize);
+        counters_.record(moved);
+    }
+}
+
+size_t StageWorker::moveItems(size_t count)
+{
+    size_t moved = 0;
+    ActorRole waitingRole = ActorRole::CONSUMER;
+    do
+    {
+        std::scoped_lock lock(stage_.mutex);
+        moved = stage_.moveItems(count, waitingRole);
+    }
+    while(moved == 0 && waitForBuffer(waitingRole));
+
+    return moved;
+}
+
+bool StageWorker::waitForBuffer(ActorRole role)
+{
+    std::shared_ptr<Wakeup> wakeup = wakeup_;
+    {
+        std::scoped_lock lock(wakeup->mutex);
+        wakeup->ready = false;
+    }
+
+    //The waiter is not registered if the buffer became ready meanwhile, and the buffer calls it when it is stopped.
+    IItemsBuffer* buffer = role == ActorRole::PRODUCER ? stage_.output : stage_.input;
+    bool registered = buffer->addWaiter(role, [wakeup](){
+        {
+            std::scoped_lock lock(wakeup->mutex);
+            wakeup->ready = true;
+        }
+        wakeup->readyCV.notify_all();
+    });
+
+    if (registered)
+    {
+        std::unique_lock<std::mutex> lock(wakeup->mutex);
+        wakeup->readyCV.wait(lock, [this, &wakeup](){
+            return wakeup->ready || !isRunning();
+        });
+    }
+
+    return isRunning() && stage_.input->isRunning() && stage_.output->isRunning();
+}
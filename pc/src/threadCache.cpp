@@ -0,0 +1,129 @@
+#include "threadCache.h"
+
+constexpr size_t ThreadCache::DEFAULT_MAX_PARKED_THREADS;
+
+ThreadCache::ThreadCache(size_t maxParkedThreads)
+: maxParkedThreads_(maxParkedThreads)
+, quitSignal_(false)
+{}
+
+ThreadCache::~ThreadCache()
+{
+    std::list<std::unique_ptr<Worker>> workers;
+    {
+        std::scoped_lock lock(mutex_);
+        quitSignal_ = true;
+        for(auto worker: parked_)
+        {
+            worker->taskCV.notify_one();
+        }
+
+        workers.swap(workers_);
+    }
+
+    for(auto& worker: workers)
+    {
+        worker->thread.join();
+    }
+
+    joinExitedThreads();
+}
+
+std::future<void> ThreadCache::run(const std::function<void()>& task)
+{
+    joinExitedThreads();
+
+    std::scoped_lock lock(mutex_);
+    Worker* worker = nullptr;
+    if (!parked_.empty())
+    {
+        worker = parked_.back();
+        parked_.pop_back();
+    }
+    else
+    {
+        workers_.emplace_back(new Worker{std::thread(), nullptr, std::promise<void>(), false, {}, {}});
+        worker = workers_.back().get();
+        worker->position = std::prev(workers_.end());
+        worker->thread = std::thread(&ThreadCache::runWorker, this, worker);
+    }
+
+    worker->task = task;
+    worker->finished = std::promise<void>();
+    worker->hasTask = true;
+    worker->taskCV.notify_one();
+    return worker->finished.get_future();
+}
+
+void ThreadCache::runWorker(Worker* worker)
+{
+    std::unique_lock<std::mutex> lock(mutex_);
+    while(true)
+    {
+        worker->taskCV.wait(lock, [this, worker](){
+            return worker->hasTask || quitSignal_;
+        });
+
+        if (!worker->hasTask)
+        {
+            return;
+        }
+
+        std::function<void()> task = std::move(worker->task);
+        std::promise<void> finished = std::move(worker->finished);
+        worker->hasTask = false;
+        lock.unlock();
+
+        task();
+        task = nullptr;
+
+        //The worker is parked before the future becomes ready, so an actor added right after another is joined reuses its thread.
+        lock.lock();
+        bool park = !quitSignal_ && parked_.size() < maxParkedThreads_;
+        if (park)
+        {
+            parked_.push_back(worker);
+        }
+        else if (!quitSignal_)
+        {
+            //Once 'quitSignal_' is raised, the destructor owns the workers and joins their threads.
+            exited_.push_back(std::move(*worker->position));
+            workers_.erase(worker->position);
+        }
+
+        lock.unlock();
+        finished.set_value();
+        if (!park)
+        {
+            return;
+        }
+
+        lock.lock();
+    }
+}
+
+void ThreadCache::joinExitedThreads()
+{
+    std::vector<std::unique_ptr<Worker>> exited;
+    {
+        std::scoped_lock lock(mutex_);
+        exited.swap(exited_);
+    }
+
+    for(auto& worker: exited)
+    {
+        worker->thread.join();
+    }
+}
+
+size_t ThreadCache::getNumberOfParkedThreads()
+{
+    std::scoped_lock lock(mutex_);
+    return parked_.size();
+}
+
+ThreadCache& ThreadCache::getDefault()
+{
+    static ThreadCache threadCache(DEFAULT_MAX_PARKED_THREADS);
+    return threadCache;
+}
@@ -0,0 +1,162 @@
+#include <thread>
+#include "waitStrategy.h"
+
+#define SPIN_ITERATIONS 1000 //The number of times that 'SpinThenParkWaitStrategy' checks the condition before waiting on the condition variable.
+
+/**
+ * Tells the processor that the calling thread is spinning, so that it can save power and give resources to the sibling hyper-thread.
+ */
+static inline void cpuRelax()
+{
+#if defined(__x86_64__) || defined(__i386__)
+    __builtin_ia32_pause();
+#elif defined(__aarch64__)
+    asm volatile("yield");
+#else
+    std::this_thread::yield();
+#endif
+}
+
+/**
+ * Calls 'probe' repeatedly without holding 'lock', calling 'relax' between two calls, and checks 'ready' with 'lock' held each time 'probe'
+ * returns true, until 'ready' returns true, 'deadline' is reached or 'probe' has been called 'maxIterations' times.
+ *
+ * @return The last value returned by 'ready'. 'lock' is held again when this function returns.
+ */
+template <class Relax>
+static bool poll(std::unique_lock<std::mutex>& lock, const std::function<bool()>& ready, const std::function<bool()>& probe,
+                 const std::chrono::steady_clock::time_point& deadline, size_t maxIterations, Relax relax)
+{
+    if (ready())
+    {
+        return true;
+    }
+
+    lock.unlock();
+    for(size_t i = 0; i < maxIterations; ++i)
+    {
+        if (probe())
+        {
+            lock.lock();
+            if (ready())
+            {
+                return true;
+            }
+            lock.unlock();
+        }
+
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            break;
+        }
+
+        relax();
+    }
+
+    lock.lock();
+    return ready();
+}
+
+std::unique_ptr<IWaitStrategy> IWaitStrategy::create(WaitStrategy type)
+{
+    switch(type)
+    {
+        case WaitStrategy::SPIN_THEN_PARK:
+            return std::unique_ptr<IWaitStrategy>(new SpinThenParkWaitStrategy);
+        case WaitStrategy::YIELDING:
+            return std::unique_ptr<IWaitStrategy>(new YieldingWaitStrategy);
+        case WaitStrategy::BUSY_POLL:
+            return std::unique_ptr<IWaitStrategy>(new BusyPollWaitStrategy);
+        case WaitStrategy::BLOCKING:
+            break;
+    }
+
+    return std::unique_ptr<IWaitStrategy>(new BlockingWaitStrategy);
+}
+
+bool BlockingWaitStrategy::wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+                                const std::function<bool()>& /*probe*/, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups)
+{
+    while(!ready())
+    {
+        if (deadline == std::chrono::steady_clock::time_point::max())
+        {
+            conditionVariable.wait(lock);
+        }
+        else if (conditionVariable.wait_until(lock, deadline) == std::cv_status::timeout)
+        {
+            return ready();
+        }
+
+        if (ready())
+        {
+            return true;
+        }
+
+        if (spuriousWakeups)
+        {
+            (*spuriousWakeups)++;
+        }
+    }
+
+    return true;
+}
+
+bool BlockingWaitStrategy::parksThreads() const
+{
+    return true;
+}
+
+bool SpinThenParkWaitStrategy::wait(std::unique_lock<std::mutex>& lock, std::condition_variable& conditionVariable, const std::function<bool()>& ready,
+                                    const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* spuriousWakeups)
+{
+    if (poll(lock, ready, probe, deadline, SPIN_ITERATIONS, cpuRelax))
+    {
+        return true;
+    }
+
+    return blockingWaitStrategy_.wait(lock, conditionVariable, ready, probe, deadline, spuriousWakeups);
+}
+
+bool SpinThenParkWaitStrategy::parksThreads() const
+{
+    return true;
+}
+
+bool YieldingWaitStrategy::wait(std::unique_lock<std::mutex>& lock, std::condition_variable& /*conditionVariable*/, const std::function<bool()>& ready,
+                                const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* /*spuriousWakeups*/)
+{
+    while(!poll(lock, ready, probe, deadline, SPIN_ITERATIONS, std::this_thread::yield))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool YieldingWaitStrategy::parksThreads() const
+{
+    return false;
+}
+
+bool BusyPollWaitStrategy::wait(std::unique_lock<std::mutex>& lock, std::condition_variable& /*conditionVariable*/, const std::function<bool()>& ready,
+                                const std::function<bool()>& probe, const std::chrono::steady_clock::time_point& deadline, size_t* /*spuriousWakeups*/)
+{
+    while(!poll(lock, ready, probe, deadline, SPIN_ITERATIONS, cpuRelax))
+    {
+        if (std::chrono::steady_clock::now() >= deadline)
+        {
+            return false;
+        }
+    }
+
+    return true;
+}
+
+bool BusyPollWaitStrategy::parksThreads() const
+{
+    return false;
+}
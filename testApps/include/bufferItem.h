@@ -2,6 +2,7 @@
 #define PC_BUFFER_ITEM_H
 
 #include <assert.h>
+#include <chrono>
 #include "IBufferItem.h"
 
 /**
@@ -34,4 +35,105 @@ private:
     bool value_;
 };
 
+/**
+ * A buffer item that takes some time to be filled and emptied, to simulate items that perform real work.
+ */
+class SlowBufferItem: public BufferItem
+{
+public:
+
+    /**
+     * Constructor.
+     *
+     * @param[in] workTime The time that it takes to fill or empty this item.
+     */
+    explicit SlowBufferItem(const std::chrono::milliseconds& workTime);
+
+    /**
+     * Waits 'workTime_' and sets this object as filled.
+     */
+    void fill() override;
+
+    /**
+     * Waits 'workTime_' and sets this object as empty.
+     */
+    void empty() override;
+
+private:
+    std::chrono::milliseconds workTime_;
+};
+
+/**
+ * A buffer item that can be filled while it is already filled, as the buffers with 'OverflowPolicy::OVERWRITE' do.
+ */
+class OverwritableBufferItem: public IBufferItem
+{
+public:
+
+    /**
+     * Sets this object as filled, even if it was already filled, and counts the fill.
+     */
+    void fill() override;
+
+    /**
+     * Sets this object as empty.
+     */
+    void empty() override;
+
+    operator bool() const override;
+
+    /**
+     * @return The number of times that this item has been filled.
+     */
+    size_t getFills() const;
+
+private:
+    bool value_ = false;
+    size_t fills_ = 0;
+};
+
+/**
+ * A buffer item without virtual methods nor pointers, that can be stored in a shared memory buffer.
+ */
+class PlainBufferItem
+{
+public:
+
+    /**
+     * Sets this object as filled (or produced by a producer).
+     */
+    void fill();
+
+    /**
+     * Sets this object as empty (or consumed by a consumer).
+     */
+    void empty();
+
+    explicit operator bool() const;
+
+private:
+    bool value_ = false;
+};
+
+/**
+ * A plain buffer item whose 'fill' never returns in the processes where stalling is enabled, to simulate a producer that dies while filling it.
+ */
+class StallingBufferItem: public PlainBufferItem
+{
+public:
+
+    /**
+     * Blocks forever if stalling is enabled in this process. Otherwise, sets this object as filled.
+     */
+    void fill();
+
+    /**
+     * @param[in] stalling Whether 'fill' blocks forever in this process.
+     */
+    static void setStalling(bool stalling);
+
+private:
+    static bool stalling_;
+};
+
 #endif
\ No newline at end of file
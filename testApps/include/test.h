@@ -1,5 +1,6 @@
 #ifndef PC_TEST_H
 #define PC_TEST_H
+#include <functional>
 #include <gtest/gtest.h>
 #include "IPC.h"
 
@@ -54,9 +55,20 @@ protected:
      *
      * @param[in] indexValue The desired index value that the buffer should have
      * @param[in] delay The expected delay that producers and/or consumers will have.
+     * @param[in] bufferSize The size of the shared buffer, when it is not 'buffer_'. If 0, the size of 'buffer_' is used.
      * @return true if the current index value of the shared buffer reaches 'indexValue', false otherwise.
      */
-    bool waitForIndexValue(size_t indexValue, uint64_t delay);
+    bool waitForIndexValue(size_t indexValue, uint64_t delay, size_t bufferSize = 0);
+
+    /**
+     * The method checks 'condition' every delay/2 milliseconds, with the same maximum number of tries as 'waitForIndexValue'.
+     *
+     * @param[in] condition The condition to wait for.
+     * @param[in] delay The expected delay that producers and/or consumers will have.
+     * @param[in] bufferSize The size of the shared buffer, when it is not 'buffer_'. If 0, the size of 'buffer_' is used.
+     * @return true if 'condition' returns true before the maximum number of tries is reached, false otherwise.
+     */
+    bool waitForCondition(const std::function<bool()>& condition, uint64_t delay, size_t bufferSize = 0);
 
     IPC::ItemsBuffer buffer_;
     unsigned long leaked, dubious, reachable, suppressed;
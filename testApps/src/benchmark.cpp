@@ -0,0 +1,81 @@
+/**
+ * An executable that measures the throughput of the shared buffer with each backend and slot layout.
+ * Usage: ./pcbench [number of threads] [duration in milliseconds]
+ */
+#include <iostream>
+#include <iomanip>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <chrono>
+#include <vector>
+#include "IPC.h"
+#include "PaddedItem.h"
+#include "eventSink.h"
+#include "bufferItem.h"
+
+#define DEFAULT_NUMBER_OF_THREADS 8
+#define DEFAULT_DURATION 2000
+#define BUFFER_SIZE 64
+
+/**
+ * Runs half of 'numberOfThreads' producers and half consumers without delay on a buffer of contiguous items, and prints the number of items
+ * produced and consumed per second.
+ *
+ * @param[in/out] items The items of the buffer. They are stored contiguously, which is the worst case for false sharing.
+ * @param[in] options The options of the buffer.
+ * @param[in] name The name of the configuration to be printed.
+ * @param[in] numberOfThreads The total number of producers and consumers.
+ * @param[in] duration The time the producers and consumers run.
+ */
+template <class Item>
+static void run(std::vector<Item>& items, BufferOptions options, const std::string& name, size_t numberOfThreads, const std::chrono::milliseconds& duration)
+{
+    IPC::ItemsBuffer buffer;
+    for(auto& item: items)
+    {
+        buffer.push_back(&item);
+    }
+
+    CountingEventSink eventSink;
+    options.eventSink = &eventSink;
+    IPC::start(buffer, options);
+    for(size_t i = 0; i < numberOfThreads / 2; ++i)
+    {
+        IPC::addProducer(std::chrono::milliseconds(0));
+        IPC::addConsumer(std::chrono::milliseconds(0));
+    }
+
+    std::this_thread::sleep_for(duration);
+    size_t operations = eventSink.getProduced() + eventSink.getConsumed();
+    IPC::stop();
+
+    std::cout << std::left << std::setw(24) << name << std::right << std::setw(14)
+              << static_cast<uint64_t>(operations * 1000.0 / duration.count()) << " items/s" << std::endl;
+}
+
+int main(int argc, char** argv)
+{
+    size_t numberOfThreads = argc > 1 ? std::stoul(argv[1]) : DEFAULT_NUMBER_OF_THREADS;
+    std::chrono::milliseconds duration(argc > 2 ? std::stoul(argv[2]) : DEFAULT_DURATION);
+
+    std::cout << numberOfThreads << " threads, " << BUFFER_SIZE << " items, " << duration.count() << " ms per configuration" << std::endl;
+
+    BufferOptions options;
+    options.waitStrategy = WaitStrategy::SPIN_THEN_PARK;
+    for(auto backend: {BufferBackend::LOCKED, BufferBackend::LOCK_FREE})
+    {
+        options.backend = backend;
+        std::string backendName = backend == BufferBackend::LOCKED ? "locked" : "lock-free";
+
+        std::vector<BufferItem> items(BUFFER_SIZE);
+        options.slotLayout = SlotLayout::COMPACT;
+        run(items, options, backendName + " compact", numberOfThreads, duration);
+
+        std::vector<PaddedItem<BufferItem>> paddedItems(BUFFER_SIZE);
+        options.slotLayout = SlotLayout::PADDED;
+        run(paddedItems, options, backendName + " padded", numberOfThreads, duration);
+    }
+
+    return 0;
+}
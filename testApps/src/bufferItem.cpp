@@ -1,3 +1,4 @@
+#include <thread>
 #include "bufferItem.h"
 
 BufferItem::BufferItem(bool filled)
@@ -19,4 +20,76 @@ void BufferItem::empty()
 BufferItem::operator bool() const
 {
     return value_;
-}
\ No newline at end of file
+}
+
+SlowBufferItem::SlowBufferItem(const std::chrono::milliseconds& workTime)
+: workTime_(workTime)
+{}
+
+void SlowBufferItem::fill()
+{
+    std::this_thread::sleep_for(workTime_);
+    BufferItem::fill();
+}
+
+void SlowBufferItem::empty()
+{
+    std::this_thread::sleep_for(workTime_);
+    BufferItem::empty();
+}
+
+void OverwritableBufferItem::fill()
+{
+    value_ = true;
+    fills_++;
+}
+
+void OverwritableBufferItem::empty()
+{
+    assert(value_);
+    value_ = false;
+}
+
+OverwritableBufferItem::operator bool() const
+{
+    return value_;
+}
+
+size_t OverwritableBufferItem::getFills() const
+{
+    return fills_;
+}
+
+void PlainBufferItem::fill()
+{
+    assert(!value_);
+    value_ = true;
+}
+
+void PlainBufferItem::empty()
+{
+    assert(value_);
+    value_ = false;
+}
+
+PlainBufferItem::operator bool() const
+{
+    return value_;
+}
+
+bool StallingBufferItem::stalling_ = false;
+
+void StallingBufferItem::fill()
+{
+    while (stalling_)
+    {
+        std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+
+    PlainBufferItem::fill();
+}
+
+void StallingBufferItem::setStalling(bool stalling)
+{
+    stalling_ = stalling;
+}
@@ -6,6 +6,7 @@
 #include <chrono>
 #include <vector>
 #include "IPC.h"
+#include "eventSink.h"
 #include "bufferItem.h"
 
 #define DEFAULT_DELAY 500       //The delay that produces and consumers will take after producing and consuming an element, respectively.
@@ -57,7 +58,10 @@ int main()
 {
     IPC::ItemsBuffer buffer;
     addBufferElements(buffer);
-    IPC::start(buffer);
+    AsyncLogEventSink eventSink;
+    BufferOptions options;
+    options.eventSink = &eventSink;
+    IPC::start(buffer, options);
 
     showMenu();
     int input = -1;
@@ -1,8 +1,43 @@
 #include <chrono>
 #include <thread>
+#include <sstream>
+#include <fstream>
+#include <coroutine>
+#include <future>
+#include <memory>
+#include <atomic>
+#include <string>
+#include <set>
+#include <filesystem>
+#include <unistd.h>
+#include <signal.h>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/wait.h>
 #include "test.h"
 #include "valgrind/memcheck.h"
 #include "bufferItem.h"
+#include "eventSink.h"
+#include "PaddedItem.h"
+#include "Pipeline.h"
+#include "executor.h"
+#include "RateLimiter.h"
+
+/**
+ * A coroutine that runs until its first suspension when it is called, and that sets 'done' when it finishes.
+ */
+struct DetachedCoroutine
+{
+    struct promise_type
+    {
+        DetachedCoroutine get_return_object() { return {}; }
+        std::suspend_never initial_suspend() { return {}; }
+        std::suspend_never final_suspend() noexcept { return {}; }
+        void return_void() {}
+        void unhandled_exception() { std::terminate(); }
+    };
+};
 
 void ProducerConsumerTest::SetUp()
 {
@@ -50,18 +85,30 @@ void ProducerConsumerTest::createProducersAndConsumers(const PC_Params& params)
     }
 }
 
-bool ProducerConsumerTest::waitForIndexValue(size_t indexValue, uint64_t delay)
+bool ProducerConsumerTest::waitForIndexValue(size_t indexValue, uint64_t delay, size_t bufferSize)
+{
+    //Here we only check that the maximum number of tries is not reached. Checking the value of the shared buffer 'buffer_' is not safe because
+    //a producer or consumer could have modified it right after the loop.
+    return waitForCondition([indexValue](){
+        return IPC::getCurrentIndex() == indexValue;
+    }, delay, bufferSize);
+}
+
+bool ProducerConsumerTest::waitForCondition(const std::function<bool()>& condition, uint64_t delay, size_t bufferSize)
 {
+    if (bufferSize == 0)
+    {
+        bufferSize = buffer_.size();
+    }
+
     size_t i = 0;
-    while(IPC::getCurrentIndex() != indexValue && i < (buffer_.size() * delay * 2))
+    while(!condition() && i < (bufferSize * delay * 2))
     {
         std::this_thread::sleep_for(std::chrono::milliseconds(delay/2));
         i++;
     }
 
-    //Here we only check that the maximum number of tries is not reached. Checking the value of the shared buffer 'buffer_' is not safe because
-    //a producer or consumer could have modified it right after the loop above.
-    return i < (buffer_.size() * delay * 2);
+    return i < (bufferSize * delay * 2);
 }
 
 TEST_F(ProducerConsumerTest, AfterInsertingALotOfConsumersAndProducersWithLongDelayIntoABigBuffer_ThenTheQuitProcessIsQuick)
@@ -92,6 +139,92 @@ TEST_F(ProducerConsumerTest, AfterInsertingALotOfConsumersAndProducersWithLongDe
     EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
 }
 
+TEST_F(ProducerConsumerTest, WhenRemovingAllActorsAtOnce_ThenTheyLeaveTheirOperationsInParallel)
+{
+    const size_t NUMBER_PRODUCERS = 10;
+    const size_t BUFFER_SIZE = 500;
+    const std::chrono::milliseconds WORK_TIME(100);
+    uint64_t MAX_ELAPSED_TIME = 2 * WORK_TIME.count(); //The producers finish their items within WORK_TIME once they are all signaled.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 20 * WORK_TIME.count();
+    }
+
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer_.push_back(new SlowBufferItem(WORK_TIME));
+    }
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_);
+
+    //Without delay, each producer is always filling an item, which it finishes before leaving.
+    auto addProducers = [&](){
+        std::vector<ProducerConsumer::ActorHandle> handles;
+        for(size_t i = 0; i < NUMBER_PRODUCERS; ++i)
+        {
+            handles.push_back(producerConsumer.addProducer(std::chrono::milliseconds(0)));
+        }
+
+        std::this_thread::sleep_for(WORK_TIME / 2);
+        return handles;
+    };
+
+    //Each producer is signaled and joined before the next one is signaled, so the waits for their items add up.
+    std::vector<ProducerConsumer::ActorHandle> handles = addProducers();
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    for(auto handle: handles)
+    {
+        producerConsumer.remove(handle).wait();
+    }
+    std::chrono::milliseconds sequentialTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+
+    //All the producers are signaled before any of them is joined, so they finish their items at the same time.
+    addProducers();
+    begin = std::chrono::steady_clock::now();
+    producerConsumer.removeProducers();
+    std::chrono::milliseconds parallelTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+
+    producerConsumer.stop();
+    EXPECT_LT(parallelTime.count(), sequentialTime.count() / 2);
+    EXPECT_LT(parallelTime.count(), MAX_ELAPSED_TIME);
+}
+
+TEST_F(ProducerConsumerTest, WhenRemovingTenThousandPooledActors_ThenTheStopIsQuick)
+{
+    const size_t NUMBER_CONSUMERS = 3333;
+    const size_t NUMBER_PRODUCERS = 6667;
+    const uint64_t DELAY = 500;
+    const size_t BIG_BUFFER_SIZE = 2000;
+    uint64_t MAX_ELAPSED_TIME = 500;
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 17000;
+    }
+
+    //The pooled actors share the threads of the pool, so this many of them does not need an OS thread each.
+    addElementsToBuffer(BIG_BUFFER_SIZE);
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_);
+    for(size_t i = 0; i < NUMBER_PRODUCERS; ++i)
+    {
+        producerConsumer.addProducer(ActorOptions(std::chrono::milliseconds(DELAY), 1, ActorExecution::SHARED_POOL));
+    }
+    for(size_t i = 0; i < NUMBER_CONSUMERS; ++i)
+    {
+        producerConsumer.addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), 1, ActorExecution::SHARED_POOL));
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 2));
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    producerConsumer.removeProducers();
+    producerConsumer.removeConsumers();
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - begin);
+    producerConsumer.stop();
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+}
+
 TEST_F(ProducerConsumerTest, WhenAddingOnlyOneProducer_ThenAfterWaitingTheSharedBufferIsFull)
 {
     const size_t BUFFER_SIZE = 100;
@@ -172,6 +305,1676 @@ TEST_F(ProducerConsumerTest, WhenAddingSeveralProducersThatFillABuffer_ThenAfter
     IPC::stop();
 }
 
+TEST_F(ProducerConsumerTest, WhenSeveralProducersFillSlowItems_ThenTheItemsAreFilledInParallel)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t NUMBER_PRODUCERS = 10;
+    const uint64_t DELAY = 1;
+    const uint64_t CHECK_DELAY = 20;
+    const std::chrono::milliseconds WORK_TIME(200);
+    uint64_t MAX_ELAPSED_TIME = 1000; //Filling the items one after the other would take BUFFER_SIZE * WORK_TIME milliseconds.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 10000;
+    }
+
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer_.push_back(new SlowBufferItem(WORK_TIME));
+    }
+    IPC::start(buffer_);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    PC_Params params(NUMBER_PRODUCERS, 0, DELAY, 0);
+    createProducersAndConsumers(params);
+
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, CHECK_DELAY));
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+    IPC::stop();
+
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_TRUE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, AfterInsertingALotOfConsumersAndProducersIntoALockFreeBuffer_ThenTheQuitProcessIsQuick)
+{
+    const size_t NUMBER_CONSUMERS = 90;
+    const size_t NUMBER_PRODUCERS = 180;
+    const uint64_t DELAY = 500;
+    const size_t BIG_BUFFER_SIZE = 2000;
+    uint64_t MAX_ELAPSED_TIME = 40; //The maximum elapsed time before and after stopping the buffer from accepting/returning elements, in milliseconds.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 17000;
+    }
+
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    addElementsToBuffer(BIG_BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    PC_Params params(NUMBER_PRODUCERS, NUMBER_CONSUMERS, DELAY, DELAY);
+    createProducersAndConsumers(params);
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 2));
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    IPC::stop();
+
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+}
+
+TEST_F(ProducerConsumerTest, WhenProducersFillALockFreeBuffer_ThenAfterRemovingAllProducersAndAddingConsumersTheBufferIsEmpty)
+{
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 20;
+    const size_t NUMBER_PRODUCERS = 5;
+    const size_t NUMBER_CONSUMERS = 5;
+
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    addElementsToBuffer(BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    PC_Params params(NUMBER_PRODUCERS, 0, DELAY, 0);
+    createProducersAndConsumers(params);
+
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+
+    IPC::removeProducers();
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_TRUE((*bufferItem));
+    }
+
+    params = PC_Params(0, NUMBER_CONSUMERS, 0, DELAY);
+    createProducersAndConsumers(params);
+
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    IPC::stop();
+
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_FALSE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenActorsAreAddedAndRemovedFromALockFreeBuffer_ThenNoItemIsLost)
+{
+    const size_t BUFFER_SIZE = 50;
+    const uint64_t DELAY = 1;
+    const size_t NUMBER_ACTORS = 4;
+    const std::chrono::milliseconds RUNNING_TIME(200);
+
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    addElementsToBuffer(BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    //One producer and one consumer use the single producer/single consumer path.
+    PC_Params params(1, 1, DELAY, DELAY);
+    createProducersAndConsumers(params);
+    std::this_thread::sleep_for(RUNNING_TIME);
+
+    params = PC_Params(NUMBER_ACTORS, NUMBER_ACTORS, DELAY, DELAY);
+    createProducersAndConsumers(params);
+    std::this_thread::sleep_for(RUNNING_TIME);
+
+    for(size_t i = 0; i < NUMBER_ACTORS; ++i)
+    {
+        IPC::removeProducer();
+        IPC::removeConsumer();
+    }
+    std::this_thread::sleep_for(RUNNING_TIME);
+    IPC::removeProducers();
+    IPC::removeConsumers();
+
+    size_t filledItems = 0;
+    for(auto bufferItem: buffer_)
+    {
+        filledItems += (*bufferItem) ? 1 : 0;
+    }
+    EXPECT_EQ(filledItems, IPC::getCurrentIndex());
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenConsumingFromAFIFOBuffer_ThenTheOldestItemsAreConsumedFirst)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t FILLED_ITEMS = 5;
+    const uint64_t DELAY = 20;
+
+    BufferOptions options;
+    options.ordering = BufferOrdering::FIFO;
+    addElementsToBuffer(BUFFER_SIZE, FILLED_ITEMS);
+    IPC::start(buffer_, options);
+
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 3));
+    IPC::removeConsumers();
+
+    const size_t remainingItems = IPC::getCurrentIndex();
+    EXPECT_LT(remainingItems, FILLED_ITEMS);
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        const bool expectedFilled = (i >= FILLED_ITEMS - remainingItems && i < FILLED_ITEMS);
+        EXPECT_EQ(expectedFilled, static_cast<bool>(*buffer_[i]));
+    }
+
+    //The producers continue after the last produced item and wrap around the end of the buffer.
+    IPC::addProducer(std::chrono::milliseconds(1));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+    IPC::stop();
+
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_TRUE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAddingAProducerThatProducesBatches_ThenTheBufferIsFilledInFewerIterations)
+{
+    const size_t BUFFER_SIZE = 100;
+    const size_t BATCH_SIZE = 10;
+    const uint64_t DELAY = 50;
+    uint64_t MAX_ELAPSED_TIME = 1500; //Producing one item per iteration would take BUFFER_SIZE * DELAY milliseconds.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 4000;
+    }
+
+    addElementsToBuffer(BUFFER_SIZE);
+    IPC::start(buffer_);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    IPC::addProducer(ActorOptions(std::chrono::milliseconds(DELAY), BATCH_SIZE));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+    IPC::stop();
+
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_TRUE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAddingAConsumerThatConsumesBatchesFromALockFreeBuffer_ThenTheBufferIsEmptiedInFewerIterations)
+{
+    const size_t BUFFER_SIZE = 100;
+    const size_t BATCH_SIZE = 10;
+    const uint64_t DELAY = 50;
+    uint64_t MAX_ELAPSED_TIME = 1500; //Consuming one item per iteration would take BUFFER_SIZE * DELAY milliseconds.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 4000;
+    }
+
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    addElementsToBuffer(BUFFER_SIZE, BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    IPC::addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), BATCH_SIZE));
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+    IPC::stop();
+
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_FALSE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenACountingEventSinkIsSet_ThenItCountsTheProducedAndConsumedItems)
+{
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 5;
+
+    CountingEventSink eventSink;
+    BufferOptions options;
+    options.eventSink = &eventSink;
+    addElementsToBuffer(BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    IPC::addProducer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+    IPC::removeProducers();
+
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    IPC::stop();
+
+    EXPECT_EQ(BUFFER_SIZE, eventSink.getProduced());
+    EXPECT_EQ(BUFFER_SIZE, eventSink.getConsumed());
+}
+
+TEST_F(ProducerConsumerTest, WhenAnAsyncLogEventSinkIsSet_ThenTheEventsAreWrittenToTheStream)
+{
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 5;
+
+    std::stringstream stream;
+    {
+        AsyncLogEventSink eventSink(stream);
+        BufferOptions options;
+        options.eventSink = &eventSink;
+        addElementsToBuffer(BUFFER_SIZE);
+        IPC::start(buffer_, options);
+
+        IPC::addProducer(std::chrono::milliseconds(DELAY));
+        EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+        IPC::stop();
+        EXPECT_EQ(0u, eventSink.getDroppedEvents());
+    }
+
+    std::string line;
+    size_t pushedLines = 0;
+    while(std::getline(stream, line))
+    {
+        pushedLines += (line == "Pushing value") ? 1 : 0;
+    }
+    EXPECT_EQ(BUFFER_SIZE, pushedLines);
+
+    //A sink without capacity still holds one event.
+    std::stringstream batchStream;
+    {
+        AsyncLogEventSink eventSink(batchStream, 0);
+        eventSink.onProduced(3);
+    }
+    EXPECT_EQ(batchStream.str(), "Pushing 3 values\n");
+}
+
+TEST_F(ProducerConsumerTest, WhenManyProducersWaitOnAFullBuffer_ThenEachConsumedItemWakesUpOnlyOneProducer)
+{
+    const size_t BUFFER_SIZE = 5;
+    const size_t NUMBER_PRODUCERS = 20;
+    const uint64_t DELAY_PRODUCERS = 1;
+    const uint64_t DELAY_CONSUMER = 20;
+    const std::chrono::milliseconds RUNNING_TIME(500);
+
+    CountingEventSink eventSink;
+    BufferOptions options;
+    options.eventSink = &eventSink;
+    addElementsToBuffer(BUFFER_SIZE, BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    PC_Params params(NUMBER_PRODUCERS, 1, DELAY_PRODUCERS, DELAY_CONSUMER);
+    createProducersAndConsumers(params);
+    std::this_thread::sleep_for(RUNNING_TIME);
+
+    //Waking up all the producers for each consumed item would cause about NUMBER_PRODUCERS - 1 spurious wakeups per item.
+    //The statistics are read before removing the actors, because each removal wakes up all of them.
+    BufferStatistics statistics = IPC::getStatistics();
+    size_t consumedItems = eventSink.getConsumed();
+    IPC::stop();
+
+    EXPECT_GT(consumedItems, 0u);
+    EXPECT_LT(statistics.spuriousWakeups, consumedItems);
+}
+
+TEST_F(ProducerConsumerTest, WhenSlowItemsArePublishedOutOfOrderToSleepingConsumers_ThenTheBufferIsDrained)
+{
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 10;
+    const BufferBackend BACKENDS[] = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    uint64_t MAX_ELAPSED_TIME = 2000;
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 4000;
+    }
+
+    //The first items are the slowest ones, so the items are published from the last to the first.
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer_.push_back(new SlowBufferItem(std::chrono::milliseconds((BUFFER_SIZE - i) * DELAY)));
+    }
+
+    for(auto backend: BACKENDS)
+    {
+        CountingEventSink eventSink;
+        BufferOptions options;
+        options.backend = backend;
+        options.eventSink = &eventSink;
+        IPC::start(buffer_, options);
+
+        //Each thread handles a single item, so the consumers woken up for the items published before the first one only get another
+        //item if they are woken up again.
+        std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+        std::chrono::steady_clock::time_point deadline = begin + std::chrono::milliseconds(MAX_ELAPSED_TIME * 2);
+        std::vector<std::thread> threads;
+        for(size_t i = 0; i < BUFFER_SIZE; ++i)
+        {
+            threads.emplace_back([deadline](){
+                IPC::consumeUntil(deadline);
+            });
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 5));
+        for(size_t i = 0; i < BUFFER_SIZE; ++i)
+        {
+            threads.emplace_back([deadline](){
+                IPC::produceUntil(deadline);
+            });
+        }
+
+        for(auto& thread: threads)
+        {
+            thread.join();
+        }
+        std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - begin;
+        IPC::stop();
+
+        EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), MAX_ELAPSED_TIME);
+        EXPECT_EQ(eventSink.getProduced(), BUFFER_SIZE);
+        EXPECT_EQ(eventSink.getConsumed(), BUFFER_SIZE);
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenUsingEachWaitStrategy_ThenTheBufferIsFilledAndEmptied)
+{
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 2;
+    const WaitStrategy WAIT_STRATEGIES[] = {WaitStrategy::BLOCKING, WaitStrategy::SPIN_THEN_PARK, WaitStrategy::YIELDING, WaitStrategy::BUSY_POLL};
+    const BufferBackend BACKENDS[] = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(auto backend: BACKENDS)
+    {
+        for(auto waitStrategy: WAIT_STRATEGIES)
+        {
+            CountingEventSink eventSink;
+            BufferOptions options;
+            options.backend = backend;
+            options.waitStrategy = waitStrategy;
+            options.eventSink = &eventSink;
+            IPC::start(buffer_, options);
+
+            //The consumer waits on the empty buffer until the producer starts.
+            IPC::addConsumer(std::chrono::milliseconds(DELAY));
+            EXPECT_TRUE(waitForCondition([&eventSink](){
+                return eventSink.getBufferEmpty() > 0;
+            }, DELAY));
+            IPC::addProducer(std::chrono::milliseconds(DELAY));
+            EXPECT_TRUE(waitForCondition([&eventSink](){
+                return eventSink.getConsumed() > 0;
+            }, DELAY));
+            IPC::removeConsumers();
+
+            //The producer waits on the full buffer until the consumer starts.
+            EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+            EXPECT_TRUE(waitForCondition([&eventSink](){
+                return eventSink.getBufferFull() > 0;
+            }, DELAY));
+            size_t produced = eventSink.getProduced();
+            IPC::addConsumer(std::chrono::milliseconds(DELAY));
+            EXPECT_TRUE(waitForCondition([&eventSink, produced](){
+                return eventSink.getProduced() > produced;
+            }, DELAY));
+            IPC::removeProducers();
+            EXPECT_TRUE(waitForIndexValue(0, DELAY));
+            IPC::stop();
+
+            for(auto bufferItem: buffer_)
+            {
+                EXPECT_FALSE((*bufferItem));
+            }
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenUsingAnInlineBufferWithWrappingBatches_ThenItIsFilledAndEmptied)
+{
+    const size_t BUFFER_SIZE = 50;
+    const size_t BATCH_SIZE = 7; //It does not divide the buffer size, so FIFO batches wrap around the end of the buffer.
+    const uint64_t DELAY = 5;
+
+    std::vector<BufferItem> items(BUFFER_SIZE);
+    BufferOptions options;
+    options.ordering = BufferOrdering::FIFO;
+    IPC::startInline(items, options);
+
+    IPC::addProducer(ActorOptions(std::chrono::milliseconds(DELAY), BATCH_SIZE));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY, BUFFER_SIZE));
+    IPC::addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), BATCH_SIZE));
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 10));
+    IPC::removeProducers();
+    EXPECT_TRUE(waitForIndexValue(0, DELAY, BUFFER_SIZE));
+    IPC::stop();
+
+    for(const auto& item: items)
+    {
+        EXPECT_FALSE(item);
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenUsingALockFreeBufferWithPaddedSlotsAndItems_ThenItIsFilledAndEmptied)
+{
+    const size_t BUFFER_SIZE = 50;
+    const uint64_t DELAY = 5;
+
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer_.push_back(new PaddedItem<BufferItem>);
+    }
+
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    options.slotLayout = SlotLayout::PADDED;
+    IPC::start(buffer_, options);
+
+    IPC::addProducer(std::chrono::milliseconds(DELAY));
+    IPC::addProducer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+    IPC::removeProducers();
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    IPC::stop();
+
+    for(auto bufferItem: buffer_)
+    {
+        EXPECT_FALSE((*bufferItem));
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAProducerOfAnotherProcessAttachesToASharedMemoryBuffer_ThenTheItemsAreHandedOverToThisProcess)
+{
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 5;
+    const size_t MAX_TRIES = 1000;
+    const std::string NAME = "/pctest_" + std::to_string(getpid());
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        //The child process attaches once the parent has created the segment, and fills the buffer.
+        bool attached = false;
+        for(size_t i = 0; i < MAX_TRIES && !(attached = IPC::attachShared<PlainBufferItem>(NAME)); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        if (!attached)
+        {
+            _exit(1);
+        }
+
+        //The library is not fork-safe, so the child does not add actors and produces the items from its own thread.
+        size_t produced = 0;
+        for(size_t i = 0; i < MAX_TRIES && produced < BUFFER_SIZE; ++i)
+        {
+            produced += IPC::produceFor(std::chrono::milliseconds(DELAY), BUFFER_SIZE - produced);
+        }
+
+        IPC::stop();
+        _exit(produced == BUFFER_SIZE ? 0 : 2);
+    }
+
+    ASSERT_TRUE(IPC::startShared<PlainBufferItem>(NAME, BUFFER_SIZE));
+    int status = -1;
+    EXPECT_EQ(waitpid(child, &status, 0), child);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    EXPECT_EQ(IPC::getCurrentIndex(), BUFFER_SIZE);
+
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(0, DELAY, BUFFER_SIZE));
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenAProducerProcessDiesWhileFillingAnItemOfASharedMemoryBuffer_ThenTheItemIsRecovered)
+{
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 5;
+    const size_t MAX_TRIES = 1000;
+    const std::string NAME = "/pctest_" + std::to_string(getpid());
+
+    pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        //The child process reserves an item and stalls while filling it, until it is killed.
+        StallingBufferItem::setStalling(true);
+        bool attached = false;
+        for(size_t i = 0; i < MAX_TRIES && !(attached = IPC::attachShared<StallingBufferItem>(NAME)); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+
+        //The library is not fork-safe, so the child does not add actors and fills the item from its own thread.
+        if (attached)
+        {
+            IPC::tryProduce();
+        }
+
+        std::this_thread::sleep_for(std::chrono::seconds(60));
+        _exit(1);
+    }
+
+    ASSERT_TRUE(IPC::startShared<StallingBufferItem>(NAME, BUFFER_SIZE));
+    EXPECT_TRUE(waitForIndexValue(1, DELAY, BUFFER_SIZE));
+
+    //While the child is alive, the consumer waits for its item, which is not taken for abandoned.
+    IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    std::this_thread::sleep_for(std::chrono::milliseconds(300));
+    EXPECT_EQ(IPC::getCurrentIndex(), 1u);
+    EXPECT_EQ(IPC::getStatistics().recoveredSlots, 0u);
+
+    //Once it dies, the consumer finds the item reserved by the dead process, which is discarded instead of consumed.
+    kill(child, SIGKILL);
+    EXPECT_EQ(waitpid(child, nullptr, 0), child);
+    EXPECT_TRUE(waitForIndexValue(0, DELAY, BUFFER_SIZE));
+    EXPECT_EQ(IPC::getStatistics().recoveredSlots, 1u);
+
+    //The recovered slot can be produced again.
+    IPC::removeConsumers();
+    IPC::addProducer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY, BUFFER_SIZE));
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenASharedMemorySegmentIsSmallerThanItsHeaderClaims_ThenItCannotBeAttached)
+{
+    const size_t BUFFER_SIZE = 1000;
+    const std::string NAME = "/pctest_" + std::to_string(getpid());
+
+    ProducerConsumer creator;
+    ASSERT_TRUE(creator.startShared<PlainBufferItem>(NAME, BUFFER_SIZE));
+
+    //The last items are cut off, while the header still counts them.
+    int fd = shm_open(NAME.c_str(), O_RDWR, 0600);
+    ASSERT_GE(fd, 0);
+    struct stat status;
+    ASSERT_EQ(fstat(fd, &status), 0);
+    ASSERT_EQ(ftruncate(fd, status.st_size - sizeof(PlainBufferItem)), 0);
+    close(fd);
+
+    ProducerConsumer attacher;
+    EXPECT_FALSE(attacher.attachShared<PlainBufferItem>(NAME));
+    creator.stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenRunningSeveralProducerConsumerObjects_ThenTheirBuffersAreIndependent)
+{
+    const size_t NUMBER_OF_BUFFERS = 4;
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 5;
+
+    addElementsToBuffer(BUFFER_SIZE * NUMBER_OF_BUFFERS);
+    std::vector<std::unique_ptr<ProducerConsumer>> producerConsumers;
+    for(size_t i = 0; i < NUMBER_OF_BUFFERS; ++i)
+    {
+        producerConsumers.emplace_back(new ProducerConsumer);
+        producerConsumers[i]->start(ProducerConsumer::ItemsBuffer(buffer_.begin() + i * BUFFER_SIZE, buffer_.begin() + (i + 1) * BUFFER_SIZE));
+        producerConsumers[i]->addProducer(std::chrono::milliseconds(DELAY));
+    }
+
+    //Only the even buffers are emptied, while the odd ones stay full.
+    std::this_thread::sleep_for(std::chrono::milliseconds(BUFFER_SIZE * DELAY * 4));
+    for(size_t i = 0; i < NUMBER_OF_BUFFERS; i += 2)
+    {
+        producerConsumers[i]->removeProducers();
+        producerConsumers[i]->addConsumer(std::chrono::milliseconds(DELAY));
+    }
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(BUFFER_SIZE * DELAY * 4));
+    for(size_t i = 0; i < NUMBER_OF_BUFFERS; ++i)
+    {
+        EXPECT_EQ(producerConsumers[i]->getCurrentIndex(), i % 2 == 0 ? 0 : BUFFER_SIZE);
+    }
+
+    //Stopping a buffer does not affect the others, and the destructor stops the remaining ones.
+    producerConsumers[0]->stop();
+    EXPECT_EQ(producerConsumers[1]->getCurrentIndex(), BUFFER_SIZE);
+    producerConsumers.clear();
+
+    for(size_t i = 0; i < buffer_.size(); ++i)
+    {
+        EXPECT_EQ(static_cast<bool>(*buffer_[i]), (i / BUFFER_SIZE) % 2 == 1);
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAProducerConsumerIsNotStartedOrIsStopped_ThenItsCallsReturnWithoutTouchingABuffer)
+{
+    const size_t BUFFER_SIZE = 10;
+
+    addElementsToBuffer(BUFFER_SIZE);
+    ProducerConsumer producerConsumer;
+    for(size_t i = 0; i < 2; ++i)
+    {
+        EXPECT_EQ(producerConsumer.addProducer(std::chrono::milliseconds(1)), 0u);
+        EXPECT_EQ(producerConsumer.addConsumer(std::chrono::milliseconds(1)), 0u);
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), 0u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+        EXPECT_EQ(producerConsumer.tryProduce(), 0u);
+        producerConsumer.removeProducers();
+        producerConsumer.removeConsumers();
+
+        //The second round runs after a start and a stop.
+        producerConsumer.start(buffer_);
+        EXPECT_EQ(producerConsumer.tryProduce(), 1u);
+        producerConsumer.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenItemsFlowThroughAPipeline_ThenEachStageMovesThemToTheNextBuffer)
+{
+    const size_t NUMBER_OF_BUFFERS = 3;
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 2;
+    const size_t MAX_TRIES = 1000;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    addElementsToBuffer(BUFFER_SIZE * NUMBER_OF_BUFFERS);
+    std::vector<Pipeline::ItemsBuffer> buffers;
+    for(size_t i = 0; i < NUMBER_OF_BUFFERS; ++i)
+    {
+        buffers.emplace_back(buffer_.begin() + i * BUFFER_SIZE, buffer_.begin() + (i + 1) * BUFFER_SIZE);
+    }
+
+    for(auto backend: BACKENDS)
+    {
+        std::vector<std::atomic<size_t>> moved(NUMBER_OF_BUFFERS - 1);
+        std::vector<Pipeline::Transform> transforms;
+        for(size_t stage = 0; stage < NUMBER_OF_BUFFERS - 1; ++stage)
+        {
+            moved[stage] = 0;
+            transforms.push_back([&moved, stage](IBufferItem& input, IBufferItem& output){
+                input.empty();
+                output.fill();
+                moved[stage]++;
+            });
+        }
+
+        BufferOptions options;
+        options.backend = backend;
+        Pipeline pipeline;
+        pipeline.start(buffers, transforms, options);
+        EXPECT_EQ(pipeline.getNumberOfStages(), NUMBER_OF_BUFFERS - 1);
+
+        pipeline.addProducer(ActorOptions(std::chrono::milliseconds(DELAY)));
+        pipeline.addWorker(0, ActorOptions(std::chrono::milliseconds(0)));
+        pipeline.addWorker(1, ActorOptions(std::chrono::milliseconds(0), 4));
+        pipeline.addConsumer(ActorOptions(std::chrono::milliseconds(0)));
+        std::this_thread::sleep_for(std::chrono::milliseconds(BUFFER_SIZE * DELAY * 5));
+        pipeline.removeProducers();
+
+        //Once the producer is removed, every item reaches the consumer.
+        auto isEmpty = [&pipeline](){
+            for(size_t i = 0; i < NUMBER_OF_BUFFERS; ++i)
+            {
+                if (pipeline.getCurrentIndex(i) != 0)
+                {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        size_t tries = 0;
+        for(; !isEmpty() && tries < MAX_TRIES; ++tries)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+        }
+        EXPECT_LT(tries, MAX_TRIES);
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 10));
+        EXPECT_TRUE(isEmpty());
+        pipeline.stop();
+
+        EXPECT_GT(moved[0].load(), 0u);
+        EXPECT_EQ(moved[0].load(), moved[1].load());
+        for(auto bufferItem: buffer_)
+        {
+            EXPECT_FALSE((*bufferItem));
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAWorkerIsRemovedWhileTheNextBufferIsFull_ThenItDoesNotDropAnyItem)
+{
+    const size_t INPUT_SIZE = 5;
+    const size_t OUTPUT_SIZE = 2;
+    const uint64_t DELAY = 10;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    for(auto backend: BACKENDS)
+    {
+        std::vector<BufferItem> items;
+        for(size_t i = 0; i < INPUT_SIZE + OUTPUT_SIZE; ++i)
+        {
+            items.emplace_back(i < INPUT_SIZE);
+        }
+
+        std::vector<Pipeline::ItemsBuffer> buffers(2);
+        for(size_t i = 0; i < items.size(); ++i)
+        {
+            buffers[i < INPUT_SIZE ? 0 : 1].push_back(&items[i]);
+        }
+
+        BufferOptions options;
+        options.backend = backend;
+        Pipeline pipeline;
+        pipeline.start(buffers, std::vector<Pipeline::Transform>(), options);
+
+        //The worker fills the second buffer and then waits for room without owning any item, leaving the rest of its batch in the first buffer.
+        pipeline.addWorker(0, ActorOptions(std::chrono::milliseconds(0), INPUT_SIZE));
+        EXPECT_TRUE(waitForCondition([&pipeline](){
+            return pipeline.getCurrentIndex(1) == OUTPUT_SIZE && pipeline.getCurrentIndex(0) == INPUT_SIZE - OUTPUT_SIZE;
+        }, DELAY, INPUT_SIZE + OUTPUT_SIZE));
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 5));
+        EXPECT_EQ(pipeline.getCurrentIndex(0), INPUT_SIZE - OUTPUT_SIZE);
+
+        pipeline.removeWorkers(0);
+        EXPECT_EQ(pipeline.getDroppedItems(0), 0u);
+        EXPECT_EQ(pipeline.getCurrentIndex(0), INPUT_SIZE - OUTPUT_SIZE);
+        pipeline.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenPooledOrCoroutineWorkersAreAdded_ThenTheyOnlyConsumeTheItemsThatTheNextBufferCanTake)
+{
+    const size_t INPUT_SIZE = 5;
+    const size_t OUTPUT_SIZE = 2;
+    const uint64_t DELAY = 10;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    const std::vector<ActorExecution> EXECUTIONS = {ActorExecution::SHARED_POOL, ActorExecution::COROUTINE};
+
+    for(auto backend: BACKENDS)
+    {
+        for(auto execution: EXECUTIONS)
+        {
+            std::vector<BufferItem> items;
+            for(size_t i = 0; i < INPUT_SIZE + OUTPUT_SIZE; ++i)
+            {
+                items.emplace_back(i < INPUT_SIZE);
+            }
+
+            std::vector<Pipeline::ItemsBuffer> buffers(2);
+            for(size_t i = 0; i < items.size(); ++i)
+            {
+                buffers[i < INPUT_SIZE ? 0 : 1].push_back(&items[i]);
+            }
+
+            BufferOptions options;
+            options.backend = backend;
+            Pipeline pipeline;
+            pipeline.start(buffers, std::vector<Pipeline::Transform>(), options);
+
+            pipeline.addWorker(0, ActorOptions(std::chrono::milliseconds(0), INPUT_SIZE, execution));
+            EXPECT_TRUE(waitForCondition([&pipeline](){
+                return pipeline.getCurrentIndex(1) == OUTPUT_SIZE;
+            }, DELAY, INPUT_SIZE + OUTPUT_SIZE));
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 5));
+            EXPECT_EQ(pipeline.getCurrentIndex(0), INPUT_SIZE - OUTPUT_SIZE);
+
+            //The worker waits for room in the next buffer, and then it moves the remaining items.
+            pipeline.addConsumer(ActorOptions(std::chrono::milliseconds(0)));
+            EXPECT_TRUE(waitForCondition([&pipeline](){
+                return pipeline.getCurrentIndex(0) == 0 && pipeline.getCurrentIndex(1) == 0;
+            }, DELAY, INPUT_SIZE + OUTPUT_SIZE));
+
+            EXPECT_EQ(pipeline.getDroppedItems(0), 0u);
+            pipeline.stop();
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenTheRoomOfTheNextBufferIsStillBeingEmptied_ThenAPooledWorkerDoesNotBlockThePool)
+{
+    const size_t INPUT_SIZE = 2;
+    const size_t OUTPUT_SIZE = 2;
+    const std::chrono::milliseconds WORK_TIME(500);
+    const uint64_t DELAY = 10;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    uint64_t MAX_ELAPSED_TIME = 100; //A step waiting for the room would hold the thread of the pool until the consumer empties its item.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 400;
+    }
+
+    for(auto backend: BACKENDS)
+    {
+        std::vector<BufferItem> inputItems(INPUT_SIZE, BufferItem(true));
+        std::vector<std::unique_ptr<SlowBufferItem>> outputItems;
+        std::vector<Pipeline::ItemsBuffer> buffers(2);
+        for(auto& item: inputItems)
+        {
+            buffers[0].push_back(&item);
+        }
+        for(size_t i = 0; i < OUTPUT_SIZE; ++i)
+        {
+            outputItems.emplace_back(new SlowBufferItem(WORK_TIME));
+            outputItems.back()->BufferItem::fill(); //Without waiting.
+            buffers[1].push_back(outputItems.back().get());
+        }
+
+        //Only the consumer takes 'WORK_TIME' to empty an item.
+        Pipeline::Transform transform = [](IBufferItem& input, IBufferItem& output){
+            input.empty();
+            static_cast<BufferItem&>(output).BufferItem::fill();
+        };
+
+        BufferOptions options;
+        options.backend = backend;
+        Pipeline pipeline;
+        pipeline.start(buffers, {transform}, options);
+
+        //The second buffer is not full while the consumer empties its oldest item, but that slot is not free yet.
+        pipeline.addConsumer(ActorOptions(std::chrono::milliseconds(0)));
+        EXPECT_TRUE(waitForCondition([&pipeline](){
+            return pipeline.getCurrentIndex(1) == OUTPUT_SIZE - 1;
+        }, DELAY, INPUT_SIZE + OUTPUT_SIZE));
+        pipeline.addWorker(0, ActorOptions(std::chrono::milliseconds(0), 1, ActorExecution::SHARED_POOL));
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+
+        std::shared_ptr<std::promise<void>> ran = std::make_shared<std::promise<void>>();
+        std::future<void> ranFuture = ran->get_future();
+        Executor::getDefault().schedule([ran](){
+            ran->set_value();
+        }, std::chrono::steady_clock::now());
+        EXPECT_TRUE(ranFuture.wait_for(std::chrono::milliseconds(MAX_ELAPSED_TIME)) == std::future_status::ready);
+        EXPECT_EQ(pipeline.getCurrentIndex(0), INPUT_SIZE);
+
+        //Each item emptied by the consumer makes room for one more item of the first buffer.
+        EXPECT_TRUE(waitForCondition([&pipeline](){
+            return pipeline.getCurrentIndex(0) == 0;
+        }, DELAY, (INPUT_SIZE + OUTPUT_SIZE) * WORK_TIME.count() / DELAY));
+        EXPECT_EQ(pipeline.getDroppedItems(0), 0u);
+        pipeline.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenPooledOrCoroutineProducersAndConsumersAreAdded_ThenTheBufferIsFilledAndEmptied)
+{
+    const size_t BUFFER_SIZE = 50;
+    const uint64_t DELAY = 2;
+    const size_t NUMBER_OF_ACTORS = 4;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    const std::vector<ActorExecution> EXECUTIONS = {ActorExecution::SHARED_POOL, ActorExecution::COROUTINE};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(size_t i = 0; i < BACKENDS.size() * EXECUTIONS.size(); ++i)
+    {
+        BufferBackend backend = BACKENDS[i % BACKENDS.size()];
+        ActorExecution execution = EXECUTIONS[i / BACKENDS.size()];
+        BufferOptions options;
+        options.backend = backend;
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer_, options);
+        for(size_t i = 0; i < NUMBER_OF_ACTORS; ++i)
+        {
+            producerConsumer.addProducer(ActorOptions(std::chrono::milliseconds(DELAY), 1, execution));
+        }
+
+        size_t tries = 0;
+        for(; producerConsumer.getCurrentIndex() != BUFFER_SIZE && tries < BUFFER_SIZE * 10; ++tries)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+        }
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+
+        producerConsumer.removeProducers();
+        for(size_t i = 0; i < NUMBER_OF_ACTORS; ++i)
+        {
+            producerConsumer.addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), 2, execution));
+        }
+
+        tries = 0;
+        for(; producerConsumer.getCurrentIndex() != 0 && tries < BUFFER_SIZE * 10; ++tries)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+        }
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), 0u);
+        producerConsumer.stop();
+
+        for(auto bufferItem: buffer_)
+        {
+            EXPECT_FALSE((*bufferItem));
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAPooledOrCoroutineConsumerFindsTheBufferEmpty_ThenItWaitsForAnItemWithoutPolling)
+{
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 2;
+    const std::chrono::milliseconds IDLE_TIME(200);
+    const size_t MAX_OPERATIONS = 3; //The first try, and the tries after the buffer is notified while the consumer is added.
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    const std::vector<ActorExecution> EXECUTIONS = {ActorExecution::SHARED_POOL, ActorExecution::COROUTINE};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(size_t i = 0; i < BACKENDS.size() * EXECUTIONS.size(); ++i)
+    {
+        BufferOptions options;
+        options.backend = BACKENDS[i % BACKENDS.size()];
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer_, options);
+
+        //The consumer registers a waiter in the empty buffer instead of trying again and again. A coroutine only counts the completed operations.
+        ProducerConsumer::ActorHandle consumer = producerConsumer.addConsumer(ActorOptions(std::chrono::milliseconds(0), 1, EXECUTIONS[i / BACKENDS.size()]));
+        std::this_thread::sleep_for(IDLE_TIME);
+        EXPECT_LE(producerConsumer.getStatistics(consumer)->operations, MAX_OPERATIONS);
+
+        //The produced item calls the waiter, which schedules the consumer again.
+        EXPECT_EQ(producerConsumer.tryProduce(), 1u);
+        size_t tries = 0;
+        for(; producerConsumer.getStatistics(consumer)->items == 0 && tries < BUFFER_SIZE * 10; ++tries)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+        }
+        EXPECT_EQ(producerConsumer.getStatistics(consumer)->items, 1u);
+        producerConsumer.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAddingThousandsOfPooledActors_ThenTheyShareAFewThreadsAndTheQuitProcessIsQuick)
+{
+    const size_t NUMBER_OF_ACTORS = 2000;
+    const size_t BUFFER_SIZE = 100;
+    const uint64_t DELAY = 500;
+    uint64_t MAX_ELAPSED_TIME = 100;
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 17000;
+    }
+
+    //Reads the number of threads of this process.
+    auto getNumberOfThreads = []()
+    {
+        std::ifstream status("/proc/self/status");
+        std::string line;
+        while(std::getline(status, line))
+        {
+            if (line.rfind("Threads:", 0) == 0)
+            {
+                return std::stoul(line.substr(8));
+            }
+        }
+        return 0ul;
+    };
+
+    addElementsToBuffer(BUFFER_SIZE);
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_);
+    size_t threadsBefore = getNumberOfThreads();
+    for(size_t i = 0; i < NUMBER_OF_ACTORS; ++i)
+    {
+        producerConsumer.addProducer(ActorOptions(std::chrono::milliseconds(DELAY), 1, ActorExecution::SHARED_POOL));
+        producerConsumer.addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), 1, ActorExecution::SHARED_POOL));
+    }
+
+    //The pool has at most one thread per core, whatever the number of actors.
+    EXPECT_LE(getNumberOfThreads(), threadsBefore + std::max(1u, std::thread::hardware_concurrency()));
+
+    std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    producerConsumer.stop();
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+}
+
+TEST_F(ProducerConsumerTest, WhenACoroutineAwaitsTheBuffer_ThenItIsResumedOnceItemsCanBeProducedOrConsumed)
+{
+    const size_t BUFFER_SIZE = 10;
+    const uint64_t DELAY = 2;
+    const size_t MAX_TRIES = 1000;
+
+    addElementsToBuffer(BUFFER_SIZE);
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_);
+
+    //The coroutine produces twice the size of the buffer, so it is suspended until the consumer makes room.
+    std::atomic<size_t> produced(0);
+    std::atomic<bool> done(false);
+    auto produceAll = [](ProducerConsumer& producerConsumer, std::atomic<size_t>& produced, std::atomic<bool>& done, size_t count) -> DetachedCoroutine
+    {
+        while(produced < count)
+        {
+            BufferAwaitable operation = producerConsumer.produce();
+            produced += co_await operation;
+        }
+        done = true;
+    };
+    produceAll(producerConsumer, produced, done, BUFFER_SIZE * 2);
+
+    size_t tries = 0;
+    for(; producerConsumer.getCurrentIndex() != BUFFER_SIZE && tries < MAX_TRIES; ++tries)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+    }
+    EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+    EXPECT_FALSE(done);
+
+    producerConsumer.addConsumer(ActorOptions(std::chrono::milliseconds(DELAY), 1, ActorExecution::COROUTINE));
+    for(tries = 0; !done && tries < MAX_TRIES; ++tries)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+    }
+    EXPECT_TRUE(done);
+    EXPECT_EQ(produced.load(), BUFFER_SIZE * 2);
+    producerConsumer.removeConsumers();
+
+    //Once the buffer is stopped, the awaited operations complete without any item.
+    std::atomic<size_t> consumed(0);
+    std::atomic<bool> stopped(false);
+    auto consumeAll = [](ProducerConsumer& producerConsumer, std::atomic<size_t>& consumed, std::atomic<bool>& stopped) -> DetachedCoroutine
+    {
+        while(true)
+        {
+            BufferAwaitable operation = producerConsumer.consume(BUFFER_SIZE);
+            size_t count = co_await operation;
+            if (count == 0)
+            {
+                break;
+            }
+            consumed += count;
+        }
+        stopped = true;
+    };
+    consumeAll(producerConsumer, consumed, stopped);
+    producerConsumer.stop();
+    for(tries = 0; !stopped && tries < MAX_TRIES; ++tries)
+    {
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY));
+    }
+    EXPECT_TRUE(stopped);
+    EXPECT_LE(consumed.load(), BUFFER_SIZE);
+}
+
+TEST_F(ProducerConsumerTest, WhenACoroutineProducesIntoALockFreeBufferBesideASingleProducer_ThenNoItemIsProducedTwice)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t COUNT = 500;
+    const uint64_t DELAY = 2;
+    const size_t MAX_TRIES = 5000;
+
+    addElementsToBuffer(BUFFER_SIZE);
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_, options);
+
+    //The ring takes its single producer path only while the producer is the only one, and the coroutine produces from the threads of the pool.
+    ProducerConsumer::ActorHandle producer = producerConsumer.addProducer(std::chrono::milliseconds(0));
+    std::atomic<size_t> produced(0);
+    std::atomic<bool> done(false);
+    auto produceAll = [](ProducerConsumer& producerConsumer, std::atomic<size_t>& produced, std::atomic<bool>& done, size_t count) -> DetachedCoroutine
+    {
+        while(produced < count)
+        {
+            BufferAwaitable operation = producerConsumer.produce();
+            produced += co_await operation;
+        }
+        done = true;
+    };
+    produceAll(producerConsumer, produced, done, COUNT);
+
+    size_t consumed = 0;
+    for(size_t tries = 0; !done && tries < MAX_TRIES; ++tries)
+    {
+        size_t count = producerConsumer.tryConsume(BUFFER_SIZE);
+        consumed += count;
+        if (count == 0)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(DELAY / 2));
+        }
+    }
+    EXPECT_TRUE(done);
+
+    //Once the buffer is full, the producer waits, and every item that it and the coroutine produced is either consumed or in the buffer.
+    EXPECT_TRUE(waitForCondition([&](){
+        return producerConsumer.getCurrentIndex() == BUFFER_SIZE &&
+               consumed + BUFFER_SIZE == producerConsumer.getStatistics(producer)->items + COUNT;
+    }, DELAY, BUFFER_SIZE));
+    producerConsumer.stop();
+
+    size_t filledItems = 0;
+    for(auto bufferItem: buffer_)
+    {
+        filledItems += (*bufferItem) ? 1 : 0;
+    }
+    EXPECT_EQ(filledItems, BUFFER_SIZE);
+}
+
+TEST_F(ProducerConsumerTest, WhenRemovingAProducerThatIsFillingASlowItem_ThenTheCallReturnsBeforeTheProducerIsDestroyed)
+{
+    const size_t BUFFER_SIZE = 10;
+    const std::chrono::milliseconds WORK_TIME(500);
+    const std::chrono::milliseconds DELAY(1);
+    uint64_t MAX_ELAPSED_TIME = 100; //Waiting for the producer would take up to WORK_TIME milliseconds.
+
+    if (RUNNING_ON_VALGRIND)
+    {
+        MAX_ELAPSED_TIME = 400;
+    }
+
+    for(size_t i = 0; i < BUFFER_SIZE; ++i)
+    {
+        buffer_.push_back(new SlowBufferItem(WORK_TIME));
+    }
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_);
+    producerConsumer.addProducer(DELAY);
+    std::this_thread::sleep_for(WORK_TIME / 5);
+
+    //The producer is filling an item, so it is destroyed in the background, and producers can be added meanwhile.
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::future<void> destroyed = producerConsumer.removeProducer();
+    producerConsumer.addProducer(DELAY);
+    std::chrono::milliseconds elapsedTime = std::chrono::duration_cast<std::chrono::milliseconds> (std::chrono::steady_clock::now() - begin);
+    EXPECT_LT(elapsedTime.count(), MAX_ELAPSED_TIME);
+    EXPECT_TRUE(destroyed.wait_for(std::chrono::milliseconds(0)) == std::future_status::timeout);
+
+    EXPECT_TRUE(destroyed.wait_for(WORK_TIME * 2) == std::future_status::ready);
+    EXPECT_TRUE(producerConsumer.removeProducer().wait_for(WORK_TIME * 2) == std::future_status::ready);
+    EXPECT_TRUE(producerConsumer.removeProducer().wait_for(std::chrono::milliseconds(0)) == std::future_status::ready);
+    producerConsumer.stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenActorsAreAddedWithHandles_ThenASpecificActorCanBeRemovedOrChanged)
+{
+    const size_t BUFFER_SIZE = 20;
+    const uint64_t DELAY = 2;
+    const std::chrono::milliseconds LONG_DELAY(60000);
+
+    addElementsToBuffer(BUFFER_SIZE, BUFFER_SIZE);
+    IPC::start(buffer_);
+
+    //Only the fast consumer empties the buffer, while the slow one rests.
+    IPC::ActorHandle slowConsumer = IPC::addConsumer(LONG_DELAY);
+    IPC::ActorHandle fastConsumer = IPC::addConsumer(std::chrono::milliseconds(DELAY));
+    EXPECT_NE(slowConsumer, 0u);
+    EXPECT_NE(slowConsumer, fastConsumer);
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    EXPECT_EQ(IPC::getStatistics(fastConsumer)->items, BUFFER_SIZE);
+    EXPECT_EQ(IPC::getStatistics(slowConsumer)->items, 0u);
+
+    IPC::remove(fastConsumer).wait();
+    EXPECT_FALSE(IPC::getStatistics(fastConsumer).has_value());
+    EXPECT_FALSE(IPC::setDelay(fastConsumer, std::chrono::milliseconds(DELAY)));
+
+    IPC::ActorHandle producer = IPC::addProducer(std::chrono::milliseconds(DELAY));
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY));
+    IPC::remove(producer).wait();
+
+    //The slow consumer is woken up to apply its new delay.
+    EXPECT_TRUE(IPC::setDelay(slowConsumer, std::chrono::milliseconds(DELAY)));
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    EXPECT_EQ(IPC::getStatistics(slowConsumer)->items, BUFFER_SIZE);
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenProducersAreAddedAndRemovedRepeatedly_ThenTheirThreadsAreReused)
+{
+    const size_t BUFFER_SIZE = 20;
+    const size_t NUMBER_OF_PRODUCERS = 5;
+    const size_t NUMBER_OF_CYCLES = 10;
+    const std::chrono::milliseconds DELAY(1);
+
+    //The ids of the threads of the process.
+    auto getThreadIds = []()
+    {
+        std::set<std::string> threadIds;
+
+        for(const auto& entry: std::filesystem::directory_iterator("/proc/self/task"))
+        {
+            threadIds.insert(entry.path().filename().string());
+        }
+
+        return threadIds;
+    };
+
+    addElementsToBuffer(BUFFER_SIZE, 0);
+    IPC::start(buffer_);
+
+    //The first cycle may create threads, and the later ones should only reuse them.
+    std::set<std::string> knownThreadIds;
+
+    for(size_t cycle = 0; cycle < NUMBER_OF_CYCLES; ++cycle)
+    {
+        for(size_t i = 0; i < NUMBER_OF_PRODUCERS; ++i)
+        {
+            IPC::addProducer(DELAY);
+        }
+
+        std::set<std::string> threadIds = getThreadIds();
+        IPC::removeProducers();
+
+        if(cycle == 0)
+        {
+            knownThreadIds = getThreadIds();
+            knownThreadIds.insert(threadIds.begin(), threadIds.end());
+        }
+        else
+        {
+            for(const auto& threadId: threadIds)
+            {
+                EXPECT_TRUE(knownThreadIds.count(threadId) == 1) << "Thread " << threadId << " was created in cycle " << cycle;
+            }
+        }
+    }
+
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenProducersRunAtAFixedRate_ThenTheyProduceTheTargetNumberOfItemsPerSecond)
+{
+    const size_t BUFFER_SIZE = 20000;
+    const double ITEMS_PER_SECOND = 10000;
+    const size_t BATCH_SIZE = 10;
+    const double TOLERANCE = 0.1;
+    const std::chrono::milliseconds RUNNING_TIME(500);
+
+    addElementsToBuffer(BUFFER_SIZE, 0);
+    IPC::start(buffer_);
+
+    //A dedicated producer sleeps 100us between items, below the resolution of a millisecond delay.
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    IPC::ActorHandle dedicatedProducer = IPC::addProducer(ActorOptions::atRate(ITEMS_PER_SECOND));
+    IPC::ActorHandle pooledProducer = IPC::addProducer(ActorOptions::atRate(ITEMS_PER_SECOND, BATCH_SIZE, ActorExecution::SHARED_POOL));
+    std::this_thread::sleep_for(RUNNING_TIME);
+
+    size_t dedicatedItems = IPC::getStatistics(dedicatedProducer)->items;
+    size_t pooledItems = IPC::getStatistics(pooledProducer)->items;
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    IPC::stop();
+
+    double expectedItems = ITEMS_PER_SECOND * elapsedSeconds;
+    EXPECT_NEAR(dedicatedItems, expectedItems, expectedItems * TOLERANCE);
+    EXPECT_NEAR(pooledItems, expectedItems, expectedItems * TOLERANCE);
+}
+
+TEST_F(ProducerConsumerTest, WhenActorsHaveNoDelay_ThenTheyRunAtFullSpeedAndStopQuickly)
+{
+    const size_t BUFFER_SIZE = 100;
+    const size_t MIN_ITEMS = 10000;
+    const std::chrono::milliseconds RUNNING_TIME(200);
+    const uint64_t MAX_ELAPSED_TIME = 500;
+
+    addElementsToBuffer(BUFFER_SIZE, 0);
+    IPC::start(buffer_);
+
+    IPC::ActorHandle producer = IPC::addProducer(std::chrono::milliseconds(0));
+    IPC::ActorHandle consumer = IPC::addConsumer(std::chrono::milliseconds(0));
+    std::this_thread::sleep_for(RUNNING_TIME);
+    EXPECT_GE(IPC::getStatistics(producer)->items, MIN_ITEMS);
+    EXPECT_GE(IPC::getStatistics(consumer)->items, MIN_ITEMS);
+
+    //The actors do not rest, so they notice the quit signal while they wait on the buffer.
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    IPC::stop();
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), MAX_ELAPSED_TIME);
+}
+
+TEST_F(ProducerConsumerTest, WhenProducersShareARateLimiter_ThenTheirCombinedRateIsCapped)
+{
+    const size_t BUFFER_SIZE = 20000;
+    const double ITEMS_PER_SECOND = 5000;
+    const size_t BURST = 10;
+    const size_t BATCH_SIZE = 5;
+    const double TOLERANCE = 0.1;
+    const std::chrono::milliseconds RUNNING_TIME(500);
+
+    addElementsToBuffer(BUFFER_SIZE, 0);
+    IPC::start(buffer_);
+
+    //Without the limiter, producers without delay would fill the buffer right away.
+    RateLimiter rateLimiter(ITEMS_PER_SECOND, BURST);
+    std::vector<IPC::ActorHandle> producers;
+    for(ActorExecution execution: {ActorExecution::DEDICATED_THREAD, ActorExecution::DEDICATED_THREAD, ActorExecution::SHARED_POOL, ActorExecution::COROUTINE})
+    {
+        ActorOptions options(std::chrono::milliseconds(0), BATCH_SIZE, execution);
+        options.rateLimiter = &rateLimiter;
+        producers.push_back(IPC::addProducer(options));
+    }
+
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    std::this_thread::sleep_for(RUNNING_TIME);
+    size_t items = 0;
+    for(IPC::ActorHandle producer: producers)
+    {
+        std::optional<ActorStatistics> statistics = IPC::getStatistics(producer);
+        EXPECT_GT(statistics->items, 0u);
+        items += statistics->items;
+    }
+
+    double elapsedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - begin).count();
+    IPC::stop();
+
+    double expectedItems = ITEMS_PER_SECOND * elapsedSeconds + BURST;
+    EXPECT_NEAR(items, expectedItems, expectedItems * TOLERANCE);
+}
+
+TEST_F(ProducerConsumerTest, WhenTheBufferIsFull_ThenTryAndDeadlineOperationsGiveUpInsteadOfBlocking)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t COUNT = 3;
+    const std::chrono::milliseconds TIMEOUT(50);
+    const std::chrono::seconds LONG_TIMEOUT(60);
+    const uint64_t MAX_ELAPSED_TIME = 1000;
+
+    addElementsToBuffer(BUFFER_SIZE, BUFFER_SIZE);
+    IPC::start(buffer_);
+
+    EXPECT_EQ(IPC::tryProduce(), 0u);
+    std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+    EXPECT_EQ(IPC::produceFor(TIMEOUT), 0u);
+    EXPECT_GE(std::chrono::steady_clock::now() - begin, TIMEOUT);
+
+    //Only the emptied items can be produced again.
+    EXPECT_EQ(IPC::tryConsume(COUNT), COUNT);
+    EXPECT_EQ(IPC::tryProduce(BUFFER_SIZE), COUNT);
+    EXPECT_EQ(IPC::consumeUntil(std::chrono::steady_clock::now() + TIMEOUT, BUFFER_SIZE), BUFFER_SIZE);
+    EXPECT_EQ(IPC::consumeFor(TIMEOUT), 0u);
+
+    //A call waiting for the buffer is woken up when it is stopped.
+    EXPECT_EQ(IPC::produceFor(TIMEOUT, BUFFER_SIZE), BUFFER_SIZE);
+    std::future<size_t> produced = std::async(std::launch::async, [&LONG_TIMEOUT](){
+        return IPC::produceFor(LONG_TIMEOUT);
+    });
+    std::this_thread::sleep_for(TIMEOUT);
+    begin = std::chrono::steady_clock::now();
+    IPC::stop();
+    EXPECT_EQ(produced.get(), 0u);
+    std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - begin;
+    EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), MAX_ELAPSED_TIME);
+}
+
+TEST_F(ProducerConsumerTest, WhenOtherThreadsCallALockFreeBufferWithASingleProducerAndConsumer_ThenNoItemIsLost)
+{
+    const size_t BUFFER_SIZE = 64;
+    const size_t CALLS = 20000;
+    const uint64_t DELAY = 2;
+
+    CountingEventSink eventSink;
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    options.eventSink = &eventSink;
+    addElementsToBuffer(BUFFER_SIZE);
+    IPC::start(buffer_, options);
+
+    //The single actors keep their role while this thread produces and consumes too, so the buffer should not use its single paths.
+    IPC::addProducer(std::chrono::milliseconds(0));
+    IPC::addConsumer(std::chrono::milliseconds(0));
+    for(size_t i = 0; i < CALLS; ++i)
+    {
+        IPC::tryProduce();
+        IPC::tryConsume();
+    }
+
+    IPC::removeProducers();
+    EXPECT_TRUE(waitForIndexValue(0, DELAY));
+    IPC::stop();
+    EXPECT_EQ(eventSink.getProduced(), eventSink.getConsumed());
+}
+
+TEST_F(ProducerConsumerTest, WhenAProducerHasATimeout_ThenItKeepsTryingWhileTheBufferIsFull)
+{
+    const size_t BUFFER_SIZE = 10;
+    const std::chrono::milliseconds DELAY(2);
+    const std::chrono::milliseconds RUNNING_TIME(50);
+
+    addElementsToBuffer(BUFFER_SIZE, BUFFER_SIZE);
+    IPC::start(buffer_);
+
+    //A blocking producer would still be waiting in its first operation.
+    ActorOptions options(DELAY);
+    options.timeout = std::chrono::nanoseconds(0);
+    IPC::ActorHandle producer = IPC::addProducer(options);
+    std::this_thread::sleep_for(RUNNING_TIME);
+    EXPECT_GT(IPC::getStatistics(producer)->operations, 1u);
+    EXPECT_EQ(IPC::getStatistics(producer)->items, 0u);
+
+    EXPECT_EQ(IPC::tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+    EXPECT_TRUE(waitForIndexValue(BUFFER_SIZE, DELAY.count()));
+    IPC::stop();
+}
+
+TEST_F(ProducerConsumerTest, WhenTheBufferIsFull_ThenTheOverflowPolicyRejectsOrDropsItemsWithoutBlocking)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t COUNT = 3;
+    const std::chrono::seconds LONG_TIMEOUT(60);
+    const uint64_t MAX_ELAPSED_TIME = 1000;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+    const std::vector<OverflowPolicy> POLICIES = {OverflowPolicy::REJECT, OverflowPolicy::DROP_OLDEST};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(auto backend: BACKENDS)
+    {
+        for(auto policy: POLICIES)
+        {
+            BufferOptions options;
+            options.backend = backend;
+            options.ordering = BufferOrdering::LIFO; //Ignored by the buffers that drop their oldest items.
+            options.overflowPolicy = policy;
+            ProducerConsumer producerConsumer;
+            producerConsumer.start(buffer_, options);
+            EXPECT_EQ(producerConsumer.tryProduce(BUFFER_SIZE), BUFFER_SIZE);
+            EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+
+            //Neither policy waits for a consumer, even with a long timeout.
+            size_t expected = policy == OverflowPolicy::REJECT ? 0 : COUNT;
+            std::chrono::steady_clock::time_point begin = std::chrono::steady_clock::now();
+            EXPECT_EQ(producerConsumer.tryProduce(COUNT), expected);
+            EXPECT_EQ(producerConsumer.produceFor(LONG_TIMEOUT, COUNT), expected);
+            std::chrono::steady_clock::duration elapsed = std::chrono::steady_clock::now() - begin;
+            EXPECT_LT(std::chrono::duration_cast<std::chrono::milliseconds>(elapsed).count(), MAX_ELAPSED_TIME);
+            EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 2 * COUNT);
+            EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+
+            EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+            EXPECT_EQ(producerConsumer.getCurrentIndex(), 0u);
+            producerConsumer.stop();
+
+            for(auto bufferItem: buffer_)
+            {
+                EXPECT_FALSE((*bufferItem));
+            }
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenAPooledProducerWaitsForRoomInARejectingBuffer_ThenItsItemsAreNotCountedAsRejected)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t BATCH_SIZE = 3;
+    const uint64_t DELAY = 5;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(auto backend: BACKENDS)
+    {
+        BufferOptions options;
+        options.backend = backend;
+        options.overflowPolicy = OverflowPolicy::REJECT;
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer_, options);
+        EXPECT_EQ(producerConsumer.tryProduce(BUFFER_SIZE - 1), BUFFER_SIZE - 1);
+
+        //The producer fills the last item and keeps trying with the rest of its batches, which it does not give up.
+        producerConsumer.addProducer(ActorOptions(std::chrono::milliseconds(DELAY), BATCH_SIZE, ActorExecution::SHARED_POOL));
+        std::this_thread::sleep_for(std::chrono::milliseconds(DELAY * 20));
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+
+        EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+        EXPECT_TRUE(waitForCondition([&producerConsumer, BUFFER_SIZE](){
+            return producerConsumer.getCurrentIndex() == BUFFER_SIZE;
+        }, DELAY, BUFFER_SIZE));
+        producerConsumer.removeProducers();
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+
+        //A caller that does not try again gives its items up, so they are still counted.
+        EXPECT_EQ(producerConsumer.tryProduce(BATCH_SIZE), 0u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, BATCH_SIZE);
+
+        EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+        producerConsumer.stop();
+        for(auto bufferItem: buffer_)
+        {
+            EXPECT_FALSE((*bufferItem));
+        }
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenALockFreeBufferHasASingleItem_ThenItCannotBeOverfilled)
+{
+    const size_t BUFFER_SIZE = 1;
+    const size_t TRIES = 3;
+
+    addElementsToBuffer(BUFFER_SIZE);
+    BufferOptions options;
+    options.backend = BufferBackend::LOCK_FREE;
+    options.overflowPolicy = OverflowPolicy::REJECT;
+    ProducerConsumer producerConsumer;
+    producerConsumer.start(buffer_, options);
+
+    //The item is only produced once until it is consumed, and 'BufferItem' asserts if it is filled twice.
+    for(size_t i = 0; i < TRIES; ++i)
+    {
+        EXPECT_EQ(producerConsumer.tryProduce(1), i == 0 ? 1u : 0u);
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+    }
+
+    EXPECT_EQ(producerConsumer.tryConsume(1), 1u);
+    EXPECT_EQ(producerConsumer.tryConsume(1), 0u);
+    EXPECT_EQ(producerConsumer.getCurrentIndex(), 0u);
+    EXPECT_EQ(producerConsumer.tryProduce(1), 1u);
+    EXPECT_EQ(producerConsumer.tryConsume(1), 1u);
+    producerConsumer.stop();
+    EXPECT_FALSE((*buffer_[0]));
+}
+
+TEST_F(ProducerConsumerTest, WhenABatchDoesNotFitInTheBuffer_ThenTheOverflowPolicyRejectsTheRemainingItems)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t COUNT = 3;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    addElementsToBuffer(BUFFER_SIZE);
+    for(auto backend: BACKENDS)
+    {
+        BufferOptions options;
+        options.backend = backend;
+        options.overflowPolicy = OverflowPolicy::REJECT;
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer_, options);
+        EXPECT_EQ(producerConsumer.tryProduce(BUFFER_SIZE - 1), BUFFER_SIZE - 1);
+
+        //Only the first item of the batch fits, and the other ones are rejected.
+        EXPECT_EQ(producerConsumer.tryProduce(COUNT), 1u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, COUNT - 1);
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+
+        EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+        producerConsumer.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenTheOldestSlotIsStillBeingEmptied_ThenNoItemIsDroppedUntilItIsReleased)
+{
+    const size_t BUFFER_SIZE = 4;
+    const std::chrono::milliseconds WORK_TIME(200);
+    const std::chrono::milliseconds DELAY(50);
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    for(auto backend: BACKENDS)
+    {
+        std::vector<IBufferItem*> buffer;
+        SlowBufferItem slowItem(WORK_TIME);
+        slowItem.fill();
+        buffer.push_back(&slowItem);
+        std::vector<BufferItem> items(BUFFER_SIZE - 1, BufferItem(true));
+        for(auto& item: items)
+        {
+            buffer.push_back(&item);
+        }
+
+        BufferOptions options;
+        options.backend = backend;
+        options.overflowPolicy = OverflowPolicy::DROP_OLDEST;
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer, options);
+
+        //The consumer reserves the oldest item, whose slot is the next one to be produced, and takes a while to empty it.
+        std::future<size_t> consumed = std::async(std::launch::async, [&producerConsumer](){
+            return producerConsumer.tryConsume(1);
+        });
+        std::this_thread::sleep_for(DELAY);
+
+        //Dropping the other items would not free the slot that the producer needs.
+        EXPECT_EQ(producerConsumer.tryProduce(1), 0u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+        EXPECT_EQ(consumed.get(), 1u);
+
+        EXPECT_EQ(producerConsumer.tryProduce(1), 1u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 0u);
+
+        //Each dropped item makes room for exactly one new item.
+        EXPECT_EQ(producerConsumer.tryProduce(1), 1u);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, 1u);
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+
+        EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+        producerConsumer.stop();
+    }
+}
+
+TEST_F(ProducerConsumerTest, WhenTheBufferOverwritesItsOldestItems_ThenTheyAreFilledAgainWithoutBeingEmptied)
+{
+    const size_t BUFFER_SIZE = 10;
+    const size_t COUNT = 3;
+    const std::vector<BufferBackend> BACKENDS = {BufferBackend::LOCKED, BufferBackend::LOCK_FREE};
+
+    for(auto backend: BACKENDS)
+    {
+        std::vector<OverwritableBufferItem> items(BUFFER_SIZE);
+        std::vector<IBufferItem*> buffer;
+        for(auto& item: items)
+        {
+            buffer.push_back(&item);
+        }
+
+        BufferOptions options;
+        options.backend = backend;
+        options.overflowPolicy = OverflowPolicy::OVERWRITE;
+        ProducerConsumer producerConsumer;
+        producerConsumer.start(buffer, options);
+        EXPECT_EQ(producerConsumer.tryProduce(BUFFER_SIZE), BUFFER_SIZE);
+        EXPECT_EQ(producerConsumer.tryProduce(COUNT), COUNT);
+        EXPECT_EQ(producerConsumer.getStatistics().droppedItems, COUNT);
+        EXPECT_EQ(producerConsumer.getCurrentIndex(), BUFFER_SIZE);
+
+        //The oldest items were the first ones.
+        for(size_t i = 0; i < BUFFER_SIZE; ++i)
+        {
+            EXPECT_EQ(items[i].getFills(), i < COUNT ? 2u : 1u);
+        }
+
+        EXPECT_EQ(producerConsumer.tryConsume(BUFFER_SIZE), BUFFER_SIZE);
+        producerConsumer.stop();
+    }
+}
+
 int main(int argc, char **argv) {
     testing::InitGoogleTest(&argc, argv);
     return RUN_ALL_TESTS();